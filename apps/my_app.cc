@@ -2,6 +2,9 @@
 
 #include "my_app.h"
 
+#include <iostream>
+#include <stdexcept>
+
 namespace myapp {
 
 // Note: These variables cannot be placed in header files as private variables,
@@ -10,14 +13,41 @@ audio::VoiceRef music_voice; // VoiceRef objects for different sounds
 audio::VoiceRef move_voice;
 audio::VoiceRef game_over_voice;
 const char kDbPath[] = "scoreboard.db"; // Name of the scoreboard database
-
-// Constructor initializes the scoreboard.db database
-MyApp::MyApp(): leaderboard_{cinder::app::getAssetPath(kDbPath).string()} {}
+// The analysis overlay scores moves on this many threads, using this many
+// random playouts for each move
+const int kAnalysisThreads = 4;
+const int kAnalysisPlayouts = 20000;
+// How many demo games the spectator grid shows
+const int kSpectatorGames = 120;
+// Where the R key records the input for the headless replay
+const char kInputRecordingPath[] = "input_recording.txt";
+// The file next to the scoreboard that keeps finished analysis scores between
+// runs, and how many positions that file can hold
+const char kAnalysisCacheName[] = "analysis_cache.bin";
+const size_t kAnalysisCacheSlots = 1 << 16;
+
+// Constructor initializes the scoreboard.db database, the analysis cache and
+// the move analyzer
+MyApp::MyApp(): leaderboard_{cinder::app::getAssetPath(kDbPath).string()},
+    analysis_cache_{OpenAnalysisCache()},
+    analyzer_{kAnalysisThreads, kAnalysisPlayouts, analysis_cache_.get()} {}
+
+std::unique_ptr<logic::AnalysisCache> MyApp::OpenAnalysisCache() {
+  // The cache may not exist yet, so it is found through the scoreboard's
+  // asset folder instead of being looked up as an asset itself
+  const std::string path = (cinder::app::getAssetPath(kDbPath).parent_path()
+      / kAnalysisCacheName).string();
+  try {
+    return std::unique_ptr<logic::AnalysisCache>(
+        new logic::AnalysisCache(path, kAnalysisCacheSlots));
+  } catch (const std::runtime_error& error) {
+    std::cerr << "Analysis scores will not be cached: " << error.what()
+              << std::endl;
+    return nullptr;
+  }
+}
 
 void MyApp::setup() {
-  SetInitialGameBoard();
-  valid_moves_ = logic::GetValidMoves(game_board_, is_white_turn_);
-  UpdateScores();
   // Creates gl textures that can be drawn to the screen
   background_ = gl::Texture2d::create(loadImage
       (loadAsset("othello_board.png")));
@@ -30,13 +60,22 @@ void MyApp::update() {
   if (!music_voice->isPlaying()) { // If the music has ended, repeat the music
     music_voice->start();
   }
+  if (is_spectating_) {
+    spectator_view_.Update();
+  }
 }
 
 void MyApp::draw() {
   gl::clear();
+  if (is_spectating_) {
+    // The spectator grid replaces the game board while it is shown
+    spectator_view_.Draw(getWindowWidth(), getWindowHeight());
+    gl::color(Color(1,1,1));
+    return;
+  }
   const Rectf board_bounds(0, 0, kBoardBounds, kBoardBounds);
   gl::draw(background_, board_bounds);// Draws the game board each frame
-  if (IsGameOver()) {
+  if (session_.IsGameOver()) {
     const Rectf reset_bounds(810, 450, 910, 550);
     gl::draw(reset_, reset_bounds);// Draws the reset button if the game is over
   }
@@ -46,88 +85,104 @@ void MyApp::draw() {
 }
 
 void MyApp::mouseDown(cinder::app::MouseEvent event) {
+  if (is_spectating_) {
+    return; // Spectators can only watch
+  }
   // This represents the bounds of the box that the reset button is drawn in
   const Rectf reset_bounds(810, 450, 910, 550);
 
   // If the game is over and the reset button is clicked, ResetGame() is invoked
-  if (IsGameOver() && event.getX() >= reset_bounds.getX1()
+  if (session_.IsGameOver() && event.getX() >= reset_bounds.getX1()
     && event.getX() <= reset_bounds.getX2()
     && event.getY() >= reset_bounds.getY1()
     && event.getY() <= reset_bounds.getY2()) {
     ResetGame();
   }
-  int x_tile_coordinate_ = event.getX();
-  int y_tile_coordinate_ = event.getY();
-
-  // The two lines below divide the x and y coordinates on the board by
-  // 90 (pixel length of each square) to get the corresponding x and y
-  // coordinates on the board (0 to 7)
-  x_tile_coordinate_ = x_tile_coordinate_ / kTileLength;
-  y_tile_coordinate_ = y_tile_coordinate_ / kTileLength;
-
-  // If the user moves (valid move), then show the new valid moves and
-  // update the board, turn, and scores
-  if (logic::IsMoveValid(x_tile_coordinate_, y_tile_coordinate_,
-      is_white_turn_, game_board_)) {
+  RecordInput(logic::InputEventType::kMouseDown, event.getX(), event.getY());
+
+  // The x and y coordinates are divided by 90 (pixel length of each square)
+  // to get the corresponding x and y coordinates on the board (0 to 7). If
+  // the user moves (valid move), the session updates the board, turn, scores
+  // and valid moves.
+  const logic::ClickResult result = session_.Click(
+      event.getX() / kTileLength, event.getY() / kTileLength);
+  if (result.is_move_played) {
     PlaySound("click");
-    valid_moves_.clear();
-    if (is_white_turn_) {
-      game_board_[x_tile_coordinate_][y_tile_coordinate_] = "white";
-    } else {
-      game_board_[x_tile_coordinate_][y_tile_coordinate_] = "black";
+    if (result.is_game_over) {
+      EndGameAndAddToLeaderboard();
     }
-
-    // Flips the pieces on the game board based on the move the user played
-    game_board_ = logic::FlipPieces(x_tile_coordinate_,
-        y_tile_coordinate_, is_white_turn_, game_board_);
-    UpdateScores();
-  } else {
-    // If the user did not select a valid move, it is still their turn. This
-    // prevents users from playing impossible moves in the game.
-    is_white_turn_ = !is_white_turn_;
-  }
-  is_white_turn_ = !is_white_turn_; // Changes whose turn it is
-  valid_moves_ = logic::GetValidMoves(game_board_, is_white_turn_);
-
-  if (valid_moves_.empty()) {
-    // If there are no valid moves, it's the other player's turn again
-    is_white_turn_ = !is_white_turn_;
-    valid_moves_ = logic::GetValidMoves(game_board_, is_white_turn_);
-  }
-
-  if (IsGameOver()) {
-    EndGameAndAddToLeaderboard();
+    StartAnalysis();
   }
 }
 
 void MyApp::mouseMove(MouseEvent event) {
-  int x_pos = event.getX();
-  int y_pos = event.getY();
-  x_pos = x_pos / kTileLength;
-  y_pos = y_pos / kTileLength;
+  if (is_spectating_) {
+    return;
+  }
+  RecordInput(logic::InputEventType::kMouseMove, event.getX(), event.getY());
+  // Shows what the game board would look like if the user played on the
+  // tile under the mouse
+  session_.Hover(event.getX() / kTileLength, event.getY() / kTileLength);
+}
 
-  // Fills the potential game board with empty strings every time the mouse
-  // moves. If the user hovers over a valid move, then the appropriate pieces
-  // in potential game board will be filled to show what the game board
-  // would look like if they moved there.
-  for (size_t i = 0; i < kBoardSize; i++) {
-    for (size_t j = 0; j < kBoardSize; j++) {
-      potential_game_board_[j][i] = "";
-    }
+void MyApp::keyDown(KeyEvent event) {
+  if (is_spectating_ && event.getCode() != KeyEvent::KEY_s) {
+    return; // Only leaving the spectator grid is allowed while watching
+  }
+  switch (event.getCode()) {
+    case KeyEvent::KEY_a:
+      // Turns the analysis overlay on or off
+      is_analysis_shown_ = !is_analysis_shown_;
+      if (is_analysis_shown_) {
+        StartAnalysis();
+      } else {
+        analyzer_.Cancel();
+      }
+      return;
+    case KeyEvent::KEY_s:
+      // Switches between the game and the spectator grid
+      is_spectating_ = !is_spectating_;
+      if (is_spectating_) {
+        spectator_view_.StartDemoGames(kSpectatorGames);
+      } else {
+        spectator_view_.StopDemoGames();
+      }
+      return;
+    case KeyEvent::KEY_r:
+      // Starts or stops recording the input. The recording saves the game
+      // and its move history, so it can be started at any point in a game.
+      if (recorder_) {
+        recorder_.reset();
+      } else {
+        recorder_.reset(new logic::InputRecorder(kInputRecordingPath,
+            session_, kTileLength));
+      }
+      return;
+    case KeyEvent::KEY_LEFT:
+      RecordInput(logic::InputEventType::kUndo);
+      session_.Undo();
+      break;
+    case KeyEvent::KEY_RIGHT:
+      RecordInput(logic::InputEventType::kRedo);
+      session_.Redo();
+      break;
+    case KeyEvent::KEY_HOME:
+      RecordInput(logic::InputEventType::kJumpToStart);
+      session_.JumpToPly(0);
+      break;
+    case KeyEvent::KEY_END:
+      RecordInput(logic::InputEventType::kJumpToEnd);
+      session_.JumpToPly(session_.GetHistory().GetNumPlies());
+      break;
+    default:
+      return;
   }
+  StartAnalysis();
+}
 
-  if (logic::IsMoveValid(x_pos, y_pos, is_white_turn_,
-      game_board_)) {
-    // The whole game board if they were to click on this piece
-    potential_game_board_ = logic::FlipPieces(x_pos, y_pos,
-        is_white_turn_, game_board_);
-    // This if-else block turns the current tile that the user is on into
-    // white or black if it's a valid move
-    if (is_white_turn_) {
-      potential_game_board_[x_pos][y_pos] = "white";
-    } else {
-      potential_game_board_[x_pos][y_pos] = "black";
-    }
+void MyApp::mouseWheel(MouseEvent event) {
+  if (is_spectating_) {
+    spectator_view_.Scroll(event.getWheelIncrement());
   }
 }
 
@@ -157,68 +212,67 @@ void PrintText(const string& text, const C& color, const cinder::ivec2& size,
 }
 
 void MyApp::DrawBoard() {
+  const vector<vector<string>>& game_board = session_.GetGameBoard();
+  const vector<vector<string>>& potential_game_board =
+      session_.GetPotentialGameBoard();
+  const bool is_white_turn = session_.IsWhiteTurn();
   // Redraws everything that goes on the board each frame
   for (size_t i = 0; i < kBoardSize; i++) {
     for (size_t j = 0; j < kBoardSize; j++) {
       int xPos = i * kTileLength + kTileCenter;
       int yPos = j * kTileLength + kTileCenter;
-      if (game_board_[i][j] == "white") {
+      if (game_board[i][j] == "white") {
         gl::color(Color(1,1,1));
         gl::drawSolidCircle( vec2(xPos, yPos), kCirclePieceRadius);
-      } else if (game_board_[i][j] == "black") {
+      } else if (game_board[i][j] == "black") {
         gl::color(Color(0,0,0));
         gl::drawSolidCircle( vec2(xPos, yPos), kCirclePieceRadius);
       }
 
       // This draws the potential game board when the user hovers over
       // a valid move so they can see what the outcome of their move would be
-      if (potential_game_board_[i][j] == "white") {
+      if (potential_game_board[i][j] == "white") {
         gl::color(Color(1,1,1));
         gl::drawSolidCircle( vec2(xPos, yPos), kCirclePieceRadius);
-      } else if (potential_game_board_[i][j] == "black") {
+      } else if (potential_game_board[i][j] == "black") {
         gl::color(Color(0,0,0));
         gl::drawSolidCircle( vec2(xPos, yPos), kCirclePieceRadius);
       }
     }
   }
 
-  for (auto& valid_move : valid_moves_) {
+  for (auto& valid_move : session_.GetValidMoves()) {
     // This draws all of the valid moves that the user can play
     int xPos = valid_move.first * kTileLength + kTileCenter;
     int yPos = valid_move.second * kTileLength + kTileCenter;
-    if (is_white_turn_) {
+    if (is_white_turn) {
       gl::color(Color(1,1,1));
     } else {
       gl::color(Color(0,0,0));
     }
     gl::drawStrokedCircle(vec2(xPos, yPos), kCirclePieceRadius);
-  }
-}
-
-void MyApp::UpdateScores() {
-  white_score_ = 0; // Sets the score to 0 because the scores will be recounted.
-  black_score_ = 0;
 
-  for (size_t i = 0; i < kBoardSize; i++) {
-    for (size_t j = 0; j < kBoardSize; j++) {
-      if (game_board_[j][i] == "white") {
-        white_score_++;
-      } else if (game_board_[j][i] == "black") {
-        black_score_++;
-      }
+    // Shows the chance of winning after this move, as far as the analyzer
+    // has worked it out. This only reads what is ready and never waits.
+    float score;
+    if (is_analysis_shown_ && analyzer_.TryGetScore(
+        valid_move.first * kBoardSize + valid_move.second, score)) {
+      const cinder::ivec2 kScoreBoxSize = {kTileLength, kTileLength / 2};
+      const int kPercent = 100;
+      const Color text_color = is_white_turn ? Color(1,1,1) : Color(0,0,0);
+      PrintText(to_string(static_cast<int>(score * kPercent)), text_color,
+                kScoreBoxSize, vec2(xPos, yPos));
     }
   }
 }
 
-bool MyApp::IsGameOver() {
-  return (white_score_ + black_score_ == (kBoardSize * kBoardSize));
-}
-
 void MyApp::DrawScoresAndText() {
   const cinder::ivec2 kBoxSize = {500, 50};
   const Color kGreen = Color(kBoardRed, kBoardGreen, kBoardBlue);
-  const string white_score_text = "White: " + to_string(white_score_);
-  const string black_score_text = "Black: " + to_string(black_score_);
+  const string white_score_text = "White: "
+      + to_string(session_.GetWhiteScore());
+  const string black_score_text = "Black: "
+      + to_string(session_.GetBlackScore());
 
   // Prints text of the scores in the side panel
   PrintText("Welcome to Othello!",
@@ -229,12 +283,12 @@ void MyApp::DrawScoresAndText() {
       vec2(kPanelCenterX, kBlackScoreY));
   // This boolean statement creates a string that will be shown on the screen
   // to display which color player's turn it is
-  string turn = is_white_turn_ ? "White" : "Black";
+  string turn = session_.IsWhiteTurn() ? "White" : "Black";
   PrintText(turn + " Turn", kGreen, kBoxSize,
             vec2(kPanelCenterX, kTurnY));
 
-  if (IsGameOver()) {
-    string winner = GetWinner();
+  if (session_.IsGameOver()) {
+    string winner = session_.GetWinner();
     if (winner == "tie") {
       PrintText("Game Over, it's a tie!", kGreen, kBoxSize,
                 vec2(kPanelCenterX, kGameOverY));
@@ -245,15 +299,6 @@ void MyApp::DrawScoresAndText() {
   }
 }
 
-string MyApp::GetWinner() {
-  if (white_score_ > black_score_) {
-    return "white";
-  } else if (white_score_ < black_score_) {
-    return "black";
-  }
-  return "tie";
-}
-
 void MyApp::PlaySound(const string& voice) {
   if (voice == "click") {
     audio::SourceFileRef source_file =
@@ -277,40 +322,38 @@ void MyApp::PlaySound(const string& voice) {
 }
 
 void MyApp::ResetGame() {
-  game_board_.clear();
-  SetInitialGameBoard();
-  is_white_turn_ = false;
-  valid_moves_ = logic::GetValidMoves(game_board_, is_white_turn_);
-  UpdateScores();
-}
-
-void MyApp::SetInitialGameBoard() {
-  // Fills game board and potential game board with empty strings initially
-  vector<string> v(kBoardSize, "");
-  for (size_t i = 0; i < kBoardSize; i++) {
-    game_board_.push_back(v);
-    potential_game_board_.push_back(v);
-  }
-
-  // Sets the starting 4 pieces in the middle of the board to white and black
-  game_board_[kFirstStartCoord][kFirstStartCoord] = "white";
-  game_board_[kFirstStartCoord][kSecondStartCoord] = "black";
-  game_board_[kSecondStartCoord][kFirstStartCoord] = "black";
-  game_board_[kSecondStartCoord][kSecondStartCoord] = "white";
+  RecordInput(logic::InputEventType::kReset);
+  session_.Reset();
+  StartAnalysis();
 }
 
 void MyApp::EndGameAndAddToLeaderboard() {
-  string winner = GetWinner();
+  string winner = session_.GetWinner();
   PlaySound("game over");
   if (winner == "tie") {
     leaderboard_.AddWinnerToScoreBoard("tie", "tie",
-                                       white_score_);
+                                       session_.GetWhiteScore());
   } else {
     string loser = (winner == "white") ? "black" : "white";
     // Adds the winner, loser, and the winning score to the sqlite scoreboard
-    int winner_score = (winner == "white") ? white_score_ : black_score_;
+    int winner_score = (winner == "white") ? session_.GetWhiteScore()
+                                           : session_.GetBlackScore();
     leaderboard_.AddWinnerToScoreBoard(winner, loser, winner_score);
   }
 }
 
+void MyApp::StartAnalysis() {
+  if (is_analysis_shown_) {
+    // Any analysis of the previous position is cancelled by the analyzer
+    analyzer_.Analyze(logic::ToPosition(session_.GetGameBoard(),
+                                        session_.IsWhiteTurn()));
+  }
+}
+
+void MyApp::RecordInput(logic::InputEventType type, int x, int y) {
+  if (recorder_) {
+    recorder_->Record(type, x, y);
+  }
+}
+
 }  // namespace myapp
@@ -13,7 +13,15 @@
 #include <sqlite_modern_cpp.h>
 #include <cinder/gl/draw.h>
 #include <cinder/gl/gl.h>
+#include <mylibrary/analysis_cache.h>
+#include <mylibrary/game_session.h>
+#include <mylibrary/input_replay.h>
 #include <mylibrary/logic.h>
+#include <mylibrary/move_analyzer.h>
+
+#include <memory>
+
+#include "spectator_view.h"
 
 using std::vector;
 using std::string;
@@ -78,6 +86,21 @@ class MyApp : public cinder::app::App {
    */
   void mouseMove(cinder::app::MouseEvent) override;
 
+  /**
+   * This method lets the players step through the moves of the game. The
+   * left and right arrow keys undo and redo one move, and the home and end
+   * keys jump to the start of the game and to the last move played. The A key
+   * turns the analysis overlay on and off, the S key switches between the
+   * game and the spectator grid, and the R key starts and stops recording the
+   * input for the headless replay.
+   */
+  void keyDown(cinder::app::KeyEvent) override;
+
+  /**
+   * This method scrolls the spectator grid when the mouse wheel is turned.
+   */
+  void mouseWheel(cinder::app::MouseEvent) override;
+
  private:
 
   /**
@@ -88,20 +111,6 @@ class MyApp : public cinder::app::App {
    */
   void DrawBoard();
 
-  /**
-   * This method loops through the board state to count up the scores for the
-   * black and white players.
-   */
-  void UpdateScores();
-
-  /**
-   * This method checks if the game is over (if the total score is 64, which
-   * means every square on the board is filled).
-   *
-   * @return whether the game is over (true) or not (false)
-   */
-  bool IsGameOver();
-
   /**
    * This method is responsible for drawing the scores and text in the right
    * hand panel. The method is called by draw, and is thus being constantly
@@ -109,14 +118,6 @@ class MyApp : public cinder::app::App {
    */
   void DrawScoresAndText();
 
-  /**
-   * This method gets the winner by comparing the black and white scores when
-   * the game is over.
-   *
-   * @return "black" if black won, "white" if white won, and "tie" if they tied
-   */
-  string GetWinner();
-
   /**
    * This method is used to play any sound during the game, depending on the
    * parameter.
@@ -131,31 +132,58 @@ class MyApp : public cinder::app::App {
    */
   void ResetGame();
 
-  /**
-   * This method sets the initial game board as all empty strings in the 2d
-   * vector of string, except the middle four pieces that are constant in
-   * Othello games.
-   */
-  void SetInitialGameBoard();
-
   /**
    * This method ends the game by adding the winner to the sql leaderboard, as
    * well as the winning player's score.
    */
   void EndGameAndAddToLeaderboard();
 
+  /**
+   * This method starts scoring the valid moves of the current turn in the
+   * background if the analysis overlay is on. It is called whenever the turn
+   * changes, and returns right away.
+   */
+  void StartAnalysis();
+
+  /**
+   * This method writes an input event to the input recording, if one is
+   * being made.
+   *
+   * @param type the kind of input event
+   * @param x the x pixel coordinate of a mouse event
+   * @param y the y pixel coordinate of a mouse event
+   */
+  void RecordInput(logic::InputEventType type, int x = 0, int y = 0);
+
+  /**
+   * This method opens the analysis cache next to the scoreboard database.
+   * The analysis overlay works without the cache, so a cache that cannot be
+   * opened is reported and left out rather than stopping the app.
+   *
+   * @return the opened cache, or null if it could not be opened
+   */
+  static std::unique_ptr<logic::AnalysisCache> OpenAnalysisCache();
+
  private:
   othello::Scoreboard leaderboard_;
   cinder::gl::Texture2dRef background_;
   cinder::gl::Texture2dRef reset_;
-  vector<vector<string>> game_board_;
-  vector<pair<int, int>> valid_moves_;
-  // Potential game board acts as the game board if the user was to play a
-  // move. They are able to see what happens when they hover over a valid move.
-  vector<vector<string>> potential_game_board_;
-  bool is_white_turn_ = false;
-  int black_score_ = 2;
-  int white_score_ = 2;
+  // The game board, hover-over board, valid moves, scores and move history.
+  // Clicking and hovering only change this, so the input replay can drive
+  // the same code without a window.
+  logic::GameSession session_;
+  // Set while the input is being recorded
+  std::unique_ptr<logic::InputRecorder> recorder_;
+  // Keeps the analyzer's finished scores between runs, if it could be
+  // opened. It is declared before the analyzer, so it outlives the
+  // analyzer's worker threads.
+  std::unique_ptr<logic::AnalysisCache> analysis_cache_;
+  // Scores the valid moves on worker threads for the analysis overlay
+  logic::MoveAnalyzer analyzer_;
+  bool is_analysis_shown_ = false;
+  // Shows many live games at once instead of the game board
+  SpectatorView spectator_view_;
+  bool is_spectating_ = false;
   const int kBoardSize = 8;
   const int kBoardBounds = getWindowBounds().getHeight();
   const int kTileLength = getWindowBounds().getHeight() / kBoardSize;
@@ -165,8 +193,6 @@ class MyApp : public cinder::app::App {
   const float kBoardRed = 46.0 / 255.0;
   const float kBoardGreen = 174.0 / 255.0;
   const float kBoardBlue = 82.0 / 255.0;
-  const int kFirstStartCoord = 3;
-  const int kSecondStartCoord = 4;
   // These vectors represent the 8 directions on the Othello board in
   // which a piece can move; used to show valid moves to the players
   const vector<int> kXChange{-1, 0, 1, -1, 1, -1, 0, 1};
@@ -0,0 +1,291 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "spectator_view.h"
+
+#include <cinder/gl/gl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace myapp {
+
+using cinder::Color;
+using cinder::Rectf;
+using cinder::vec2;
+
+namespace {
+
+// Room for a few frames' worth of moves from every game
+const size_t kQueueCapacity = 1 << 14;
+// Segments used to approximate each disc
+const uint32_t kDiscSegments = 12;
+// Every board has the same vertices: its background, its grid lines, and a
+// disc on every square
+const int kRectsPerBoard = 1 + 2 * (logic::kBoardSize - 1);
+const uint32_t kVerticesPerRect = 4;
+const uint32_t kVerticesPerDisc = 1 + kDiscSegments;
+const size_t kVerticesPerBoard = kRectsPerBoard * kVerticesPerRect
+    + logic::kNumSquares * kVerticesPerDisc;
+const size_t kIndicesPerBoard = kRectsPerBoard * 6
+    + logic::kNumSquares * kDiscSegments * 3;
+// How long the demo games wait between moves
+const std::chrono::milliseconds kDemoMoveDelay(100);
+// The same board green as the main game, darker for finished games
+const Color kBoardColor(46.0f / 255.0f, 174.0f / 255.0f, 82.0f / 255.0f);
+const Color kFinishedBoardColor(23.0f / 255.0f, 87.0f / 255.0f, 41.0f / 255.0f);
+const Color kGridLineColor(0.1f, 0.3f, 0.15f);
+const Color kWhiteColor(1, 1, 1);
+const Color kBlackColor(0, 0, 0);
+const float kPi = 3.14159265f;
+
+}  // namespace
+
+const size_t SpectatorView::kDefaultMaxGames;
+
+SpectatorView::SpectatorView(size_t max_games)
+    : queue_{kQueueCapacity}, max_games_{max_games} {
+  boards_.reserve(max_games_);
+  game_slots_.reserve(max_games_);
+}
+
+SpectatorView::~SpectatorView() {
+  StopDemoGames();
+}
+
+void SpectatorView::StartDemoGames(int num_games) {
+  if (is_demo_running_ || num_games <= 0) {
+    return;
+  }
+  is_demo_running_ = true;
+  // Splits the games as evenly as possible between the demo threads
+  const uint32_t num_threads = static_cast<uint32_t>(
+      std::min(kDemoThreads, num_games));
+  const uint32_t total_games = static_cast<uint32_t>(num_games);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    const uint32_t first_game_id = total_games * i / num_threads;
+    const uint32_t last_game_id = total_games * (i + 1) / num_threads;
+    demo_threads_.emplace_back(&SpectatorView::PlayDemoGames, this,
+                               first_game_id, last_game_id - first_game_id);
+  }
+}
+
+void SpectatorView::StopDemoGames() {
+  is_demo_running_ = false;
+  for (auto& thread : demo_threads_) {
+    thread.join();
+  }
+  demo_threads_.clear();
+}
+
+logic::SnapshotQueue& SpectatorView::GetQueue() {
+  return queue_;
+}
+
+void SpectatorView::Update() {
+  logic::BoardSnapshot snapshot;
+  while (queue_.TryPop(snapshot)) {
+    auto slot = game_slots_.find(snapshot.game_id);
+    if (slot == game_slots_.end()) {
+      if (boards_.size() >= max_games_) {
+        continue; // The grid is full, so new games are not shown
+      }
+      slot = game_slots_.emplace(snapshot.game_id, boards_.size()).first;
+      boards_.push_back(snapshot);
+    } else {
+      boards_[slot->second] = snapshot;
+    }
+    is_mesh_outdated_ = true;
+  }
+}
+
+void SpectatorView::Draw(int width, int height) {
+  if (width != last_width_ || height != last_height_) {
+    last_width_ = width;
+    last_height_ = height;
+    is_mesh_outdated_ = true;
+  }
+  if (is_mesh_outdated_) {
+    UpdateMesh(width, height);
+    is_mesh_outdated_ = false;
+  }
+  if (!boards_.empty()) {
+    // Every visible board is in this one mesh, so this is one draw call
+    cinder::gl::ScopedGlslProg shader(
+        cinder::gl::getStockShader(cinder::gl::ShaderDef().color()));
+    cinder::gl::draw(mesh_);
+  }
+}
+
+void SpectatorView::Scroll(float wheel_increment) {
+  const int cell_length = kBoardLength + kBoardMargin;
+  const int num_columns =
+      std::max(1, (last_width_ - kBoardMargin) / cell_length);
+  const int num_rows =
+      (static_cast<int>(boards_.size()) + num_columns - 1) / num_columns;
+  const float max_offset = std::max(0.0f, static_cast<float>(
+      num_rows * cell_length + kBoardMargin - last_height_));
+
+  // One notch of the wheel scrolls half a board
+  scroll_offset_ -= wheel_increment * static_cast<float>(cell_length) / 2;
+  scroll_offset_ = std::min(std::max(scroll_offset_, 0.0f), max_offset);
+  is_mesh_outdated_ = true;
+}
+
+void SpectatorView::CreateMesh(size_t num_slots) {
+  const size_t num_vertices = num_slots * kVerticesPerBoard;
+  std::vector<uint32_t> indices;
+  indices.reserve(num_slots * kIndicesPerBoard);
+  uint32_t first = 0;
+  for (size_t slot = 0; slot < num_slots; slot++) {
+    for (int i = 0; i < kRectsPerBoard; i++) {
+      indices.insert(indices.end(),
+                     {first, first + 1, first + 2, first, first + 2, first + 3});
+      first += kVerticesPerRect;
+    }
+    for (int square = 0; square < logic::kNumSquares; square++) {
+      for (uint32_t i = 0; i < kDiscSegments; i++) {
+        indices.insert(indices.end(), {first, first + 1 + i,
+                                       first + 1 + (i + 1) % kDiscSegments});
+      }
+      first += kVerticesPerDisc;
+    }
+  }
+
+  positions_.assign(num_vertices, vec2());
+  colors_.assign(num_vertices, kBoardColor);
+  // The vertices change often, so they are kept apart from the indices
+  const std::vector<cinder::gl::VboMesh::Layout> layouts = {
+      cinder::gl::VboMesh::Layout().usage(GL_DYNAMIC_DRAW)
+          .attrib(cinder::geom::POSITION, 2),
+      cinder::gl::VboMesh::Layout().usage(GL_DYNAMIC_DRAW)
+          .attrib(cinder::geom::COLOR, 3)};
+  mesh_ = cinder::gl::VboMesh::create(
+      static_cast<uint32_t>(num_vertices), GL_TRIANGLES, layouts,
+      static_cast<uint32_t>(indices.size()), GL_UNSIGNED_INT);
+  mesh_->bufferIndices(indices.size() * sizeof(uint32_t), indices.data());
+  num_slots_ = num_slots;
+}
+
+void SpectatorView::UpdateMesh(int width, int height) {
+  const int cell_length = kBoardLength + kBoardMargin;
+  const int num_columns = std::max(1, (width - kBoardMargin) / cell_length);
+  // Enough rows to fill the window however far the grid is scrolled
+  const int num_rows = std::max(0, height) / cell_length + 2;
+  const size_t num_slots = static_cast<size_t>(num_columns * num_rows);
+  if (num_slots != num_slots_) {
+    CreateMesh(num_slots);
+  }
+
+  // Only the rows that are at least partly on screen go into the mesh
+  const int first_row = static_cast<int>(scroll_offset_) / cell_length;
+  for (size_t slot = 0; slot < num_slots; slot++) {
+    const int row = first_row + static_cast<int>(slot) / num_columns;
+    const int column = static_cast<int>(slot) % num_columns;
+    const size_t index = static_cast<size_t>(row * num_columns + column);
+    const size_t vertex = slot * kVerticesPerBoard;
+    if (index >= boards_.size()) {
+      // Slots past the last game are collapsed so nothing is drawn for them
+      std::fill(positions_.begin() + vertex,
+                positions_.begin() + vertex + kVerticesPerBoard, vec2());
+      continue;
+    }
+    const vec2 origin(
+        static_cast<float>(kBoardMargin + column * cell_length),
+        static_cast<float>(kBoardMargin + row * cell_length)
+            - scroll_offset_);
+    WriteBoard(vertex, boards_[index], origin);
+  }
+
+  // Uploads into the existing buffers instead of allocating new ones
+  mesh_->bufferAttrib(cinder::geom::POSITION, positions_);
+  mesh_->bufferAttrib(cinder::geom::COLOR, colors_);
+}
+
+void SpectatorView::WriteBoard(size_t vertex,
+                               const logic::BoardSnapshot& board,
+                               const vec2& origin) {
+  const float board_length = static_cast<float>(kBoardLength);
+  const float tile_length = board_length / logic::kBoardSize;
+  const float line_width = 1.0f;
+  WriteRect(vertex, Rectf(origin, origin + vec2(board_length, board_length)),
+            board.is_game_over ? kFinishedBoardColor : kBoardColor);
+
+  for (int i = 1; i < logic::kBoardSize; i++) {
+    const float offset = static_cast<float>(i) * tile_length;
+    WriteRect(vertex, Rectf(origin.x + offset, origin.y,
+                            origin.x + offset + line_width,
+                            origin.y + board_length), kGridLineColor);
+    WriteRect(vertex, Rectf(origin.x, origin.y + offset,
+                            origin.x + board_length,
+                            origin.y + offset + line_width), kGridLineColor);
+  }
+
+  // Like the main board, x goes across and y goes down. Every square has a
+  // disc in the mesh, and the discs of empty squares have no radius.
+  const float disc_radius = tile_length * 0.4f;
+  const uint64_t discs = board.position.black | board.position.white;
+  for (int square = 0; square < logic::kNumSquares; square++) {
+    const float x = static_cast<float>(square / logic::kBoardSize);
+    const float y = static_cast<float>(square % logic::kBoardSize);
+    const vec2 center(origin.x + (x + 0.5f) * tile_length,
+                      origin.y + (y + 0.5f) * tile_length);
+    const bool has_disc = (discs >> square) & 1;
+    const bool is_black = (board.position.black >> square) & 1;
+    WriteCircle(vertex, center, has_disc ? disc_radius : 0.0f,
+                is_black ? kBlackColor : kWhiteColor);
+  }
+}
+
+void SpectatorView::WriteRect(size_t& vertex, const Rectf& rect,
+                              const Color& color) {
+  positions_[vertex] = rect.getUpperLeft();
+  positions_[vertex + 1] = rect.getUpperRight();
+  positions_[vertex + 2] = rect.getLowerRight();
+  positions_[vertex + 3] = rect.getLowerLeft();
+  std::fill(colors_.begin() + vertex,
+            colors_.begin() + vertex + kVerticesPerRect, color);
+  vertex += kVerticesPerRect;
+}
+
+void SpectatorView::WriteCircle(size_t& vertex, const vec2& center,
+                                float radius, const Color& color) {
+  positions_[vertex] = center;
+  for (uint32_t i = 0; i < kDiscSegments; i++) {
+    const float angle = 2 * kPi * static_cast<float>(i) / kDiscSegments;
+    positions_[vertex + 1 + i] =
+        center + radius * vec2(std::cos(angle), std::sin(angle));
+  }
+  std::fill(colors_.begin() + vertex,
+            colors_.begin() + vertex + kVerticesPerDisc, color);
+  vertex += kVerticesPerDisc;
+}
+
+void SpectatorView::PlayDemoGames(uint32_t first_game_id,
+                                  uint32_t num_games) {
+  logic::XorShift64 rng(first_game_id);
+  std::vector<logic::BoardSnapshot> games(num_games);
+  for (uint32_t i = 0; i < num_games; i++) {
+    games[i].game_id = first_game_id + i;
+    games[i].position = logic::InitialPosition();
+  }
+
+  while (is_demo_running_) {
+    for (auto& game : games) {
+      if (game.is_game_over) {
+        // Starts a new game on the board of one that has finished
+        game.position = logic::InitialPosition();
+        game.is_game_over = false;
+      } else {
+        game.position = logic::ApplyMove(
+            game.position, logic::PickRandomMove(game.position, rng));
+        game.is_game_over = logic::IsTerminal(game.position);
+      }
+      // If the viewer falls behind this snapshot is dropped, never waited on
+      queue_.TryPush(game);
+    }
+    std::this_thread::sleep_for(kDemoMoveDelay);
+  }
+}
+
+}  // namespace myapp
@@ -0,0 +1,146 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_SPECTATOR_VIEW_H_
+#define FINALPROJECT_APPS_SPECTATOR_VIEW_H_
+
+#include <cinder/Color.h>
+#include <cinder/gl/VboMesh.h>
+#include <mylibrary/snapshot_queue.h>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace myapp {
+
+/**
+ * A spectator mode that shows many live games at once in a scrolling grid of
+ * small boards. Games report their boards through a lock-free snapshot queue,
+ * and every frame the view only drains that queue. All visible boards are
+ * put into a single mesh, so the whole grid is drawn with one draw call.
+ * Every board has the same triangles, so the mesh is only created again
+ * when the window is resized; otherwise its vertices are rewritten in place
+ * when a board changed or the grid scrolled.
+ */
+class SpectatorView {
+ public:
+  // How many games the grid shows at most, unless told otherwise
+  static const size_t kDefaultMaxGames = 1024;
+
+  /**
+   * Creates the view with an empty grid and no games running.
+   *
+   * @param max_games how many games the grid shows at most; snapshots of
+   * further games are ignored
+   */
+  explicit SpectatorView(size_t max_games = kDefaultMaxGames);
+
+  /**
+   * Stops the demo games, if they are running.
+   */
+  ~SpectatorView();
+
+  /**
+   * Starts background threads that play random games against each other and
+   * feed their boards to the view, so the grid can be tried out without a
+   * tournament running.
+   *
+   * @param num_games how many games to play at the same time
+   */
+  void StartDemoGames(int num_games);
+
+  /**
+   * Stops and joins the demo game threads.
+   */
+  void StopDemoGames();
+
+  /**
+   * This is the queue game threads push their boards to. Pushing never
+   * blocks, so games are not slowed down by being watched.
+   *
+   * @return the snapshot queue of the view
+   */
+  logic::SnapshotQueue& GetQueue();
+
+  /**
+   * Takes every waiting snapshot off the queue and keeps the latest board of
+   * each game. Games get grid slots in the order they are first seen, so
+   * game ids can be anything. Called once per frame from Cinder's update.
+   */
+  void Update();
+
+  /**
+   * Draws the visible part of the grid.
+   *
+   * @param width the width of the window in pixels
+   * @param height the height of the window in pixels
+   */
+  void Draw(int width, int height);
+
+  /**
+   * Scrolls the grid up or down.
+   *
+   * @param wheel_increment how far the mouse wheel was turned
+   */
+  void Scroll(float wheel_increment);
+
+ private:
+  /**
+   * Creates mesh_ with room for the given number of boards and the
+   * triangles of each of them.
+   */
+  void CreateMesh(size_t num_slots);
+
+  /**
+   * Writes every board that is visible in the window into mesh_, creating
+   * the mesh again only if the window now fits a different number of boards.
+   */
+  void UpdateMesh(int width, int height);
+
+  /**
+   * Writes the squares, grid lines and discs of one board, starting at the
+   * given vertex.
+   */
+  void WriteBoard(size_t vertex, const logic::BoardSnapshot& board,
+                  const cinder::vec2& origin);
+
+  /**
+   * Writes a solid quad or a solid circle and moves vertex past it.
+   */
+  void WriteRect(size_t& vertex, const cinder::Rectf& rect,
+                 const cinder::Color& color);
+  void WriteCircle(size_t& vertex, const cinder::vec2& center, float radius,
+                   const cinder::Color& color);
+
+  /**
+   * Plays random games with the given ids until the demo is stopped.
+   */
+  void PlayDemoGames(uint32_t first_game_id, uint32_t num_games);
+
+  logic::SnapshotQueue queue_;
+  // The latest board of every game, in the order the games were first seen
+  std::vector<logic::BoardSnapshot> boards_;
+  // The index in boards_ of each game id
+  std::unordered_map<uint32_t, size_t> game_slots_;
+  size_t max_games_;
+  cinder::gl::VboMeshRef mesh_;
+  // The vertices of mesh_, kept so they can be rewritten and uploaded
+  std::vector<cinder::vec2> positions_;
+  std::vector<cinder::Color> colors_;
+  size_t num_slots_ = 0; // How many boards mesh_ has room for
+  bool is_mesh_outdated_ = true;
+  float scroll_offset_ = 0;
+  int last_width_ = 0;
+  int last_height_ = 0;
+  std::atomic<bool> is_demo_running_{false};
+  std::vector<std::thread> demo_threads_;
+  const int kBoardLength = 160; // Side of one small board, in pixels
+  const int kBoardMargin = 12;  // Space between the small boards
+  const int kDemoThreads = 4;
+};
+
+}  // namespace myapp
+
+#endif  // FINALPROJECT_APPS_SPECTATOR_VIEW_H_
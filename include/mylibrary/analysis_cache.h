@@ -0,0 +1,150 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_ANALYSIS_CACHE_H
+#define FINALPROJECT_ANALYSIS_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+// The best move of an analysis that does not know one. Unlike kPassMove,
+// this does not claim that passing is best.
+const int kNoMove = -1;
+
+// Playout scores are the side to move's chance of winning, in millionths
+const int kPlayoutScoreScale = 1000000;
+
+/**
+ * How a position was analysed. Each kind is stored under its own keys, so a
+ * lookup only ever finds analyses of the kind it asks for.
+ */
+enum class AnalysisKind {
+  kSearch,   // A game tree search
+  kPlayouts  // Random playouts, as run by the move analyzer
+};
+
+/**
+ * What a search or a batch of playouts found out about a position.
+ */
+struct CachedAnalysis {
+  AnalysisKind kind = AnalysisKind::kSearch;
+  // How many plies deep a search went, or how many playouts were run
+  int depth = 0;
+  // A search's score for the side to move, or for playouts the side to
+  // move's chance of winning in units of 1 / kPlayoutScoreScale
+  int score = 0;
+  // The best move for the side to move, which may be kPassMove, or kNoMove
+  // if the analysis does not know it
+  int best_move = kNoMove;
+};
+
+/**
+ * A fixed-size hash table of analysed positions that lives in a
+ * memory-mapped file, so results survive restarts and are shared by every
+ * process that opens the same file.
+ *
+ * Slots are written without locks: each slot stores its data and the data
+ * XORed with the position's hash, both as atomics. A reader only accepts a
+ * slot whose two words agree, so an entry that is being overwritten by
+ * another thread or process at the same time is simply a miss.
+ *
+ * Opening the file is serialized between processes with a file lock, so a
+ * new file is sized and given its header by exactly one of them.
+ */
+class AnalysisCache {
+ public:
+  // Deeper analyses are stored with this depth
+  static const int kMaxDepth = (1 << 22) - 1;
+
+  /**
+   * Opens the cache file, creating and sizing it if it does not exist yet.
+   * An existing file keeps the size it was created with.
+   *
+   * @param path the path of the cache file
+   * @param num_slots how many positions a new cache file can hold
+   * @throws std::runtime_error if the file cannot be opened or mapped, or is
+   * not an analysis cache
+   */
+  AnalysisCache(const std::string& path, size_t num_slots);
+
+  /**
+   * Unmaps the file. Everything stored stays in the file.
+   */
+  ~AnalysisCache();
+
+  AnalysisCache(const AnalysisCache&) = delete;
+  AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+  /**
+   * @param position the position to look up
+   * @param analysis set to the stored analysis if there is one
+   * @param kind the kind of analysis to look for
+   * @return whether an analysis of that kind was found for the position
+   */
+  bool Lookup(const Position& position, CachedAnalysis& analysis,
+              AnalysisKind kind = AnalysisKind::kSearch) const;
+
+  /**
+   * Stores the analysis of a position. An existing entry of the same kind for
+   * the position is only replaced by an analysis that is at least as deep,
+   * and when all slots the position can go in are taken, the shallowest one
+   * is replaced.
+   *
+   * @param position the position that was analysed
+   * @param analysis what the search found
+   */
+  void Store(const Position& position, const CachedAnalysis& analysis);
+
+  /**
+   * @return how many slots the table has
+   */
+  size_t GetNumSlots() const;
+
+  /**
+   * @param position any position
+   * @return the non-zero 64-bit key the position is stored under
+   */
+  static uint64_t HashPosition(const Position& position);
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> check;  // key ^ data
+    std::atomic<uint64_t> data;
+  };
+
+  struct Header {
+    std::atomic<uint64_t> magic;  // Written last, once num_slots is set
+    std::atomic<uint64_t> num_slots;
+  };
+
+  // Opens and locks the file, sizes it if it is new, and maps it, setting
+  // header_ and slots_. The lock is held until Unlock is called.
+  void Map(const std::string& path, size_t num_slots);
+
+  // Releases the lock taken by Map, so other processes can open the file.
+  void Unlock();
+
+  // Unmaps and closes the file, if it is open.
+  void Unmap();
+
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+#ifdef _WIN32
+  void* file_handle_ = nullptr;
+  void* mapping_handle_ = nullptr;
+#else
+  int file_descriptor_ = -1;
+#endif
+  Header* header_ = nullptr;
+  Slot* slots_ = nullptr;
+  size_t num_slots_ = 0;
+};
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_ANALYSIS_CACHE_H
@@ -0,0 +1,181 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_BITBOARD_H
+#define FINALPROJECT_BITBOARD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mylibrary/logic.h"
+
+namespace logic {
+
+// A square on the bitboard is x * kBoardSize + y, so bit indices line up with
+// game_board_[x][y]. kPassMove is used by the engines when a side must pass.
+const int kNumSquares = kBoardSize * kBoardSize;
+const int kPassMove = kNumSquares;
+
+// The directions a disc can step in, as used by Shift. Direction d and
+// direction kNumDirections - 1 - d point opposite ways along the same line.
+const int kNumDirections = 8;
+
+/**
+ * A compact representation of an Othello position: one bit per square for
+ * each colour, plus whose turn it is. Unlike the vector<vector<string>> game
+ * board, copying and updating a Position never touches the heap, which is what
+ * the search engines and playouts rely on.
+ */
+struct Position {
+  uint64_t black = 0;
+  uint64_t white = 0;
+  bool is_white_turn = false;
+};
+
+/**
+ * The SplitMix64 finalizer, which scrambles every bit of its input into every
+ * bit of its output. It seeds XorShift64 and hashes positions.
+ *
+ * @param x any value
+ * @return the scrambled value
+ */
+uint64_t SplitMix64(uint64_t x);
+
+/**
+ * A small xorshift64* random number generator. It is fast enough to be called
+ * once per playout move and is fully determined by its seed.
+ */
+class XorShift64 {
+ public:
+  /**
+   * Creates a generator from any seed (zero included) by scrambling the seed
+   * first, so nearby seeds still produce unrelated streams.
+   *
+   * @param seed the seed of the generator
+   */
+  explicit XorShift64(uint64_t seed);
+
+  /**
+   * @return the next 64 random bits
+   */
+  uint64_t Next();
+
+  /**
+   * @param bound the exclusive upper bound, must be greater than zero
+   * @return a random number in [0, bound)
+   */
+  uint32_t NextBelow(uint32_t bound);
+
+ private:
+  uint64_t state_;
+};
+
+/**
+ * @return the starting position of an Othello game, with black to move
+ */
+Position InitialPosition();
+
+/**
+ * Converts the string game board used by the app into a Position.
+ *
+ * @param game_board_ the current state of the game board
+ * @param is_white_turn_ whether it is white's turn or not
+ * @return the same position as a pair of bitboards
+ */
+Position ToPosition(const vector<vector<string>>& game_board_,
+                    bool is_white_turn_);
+
+/**
+ * Converts a Position back into the string game board used by the app.
+ *
+ * @param position the position to convert
+ * @return an 8x8 board of "", "black" and "white"
+ */
+vector<vector<string>> ToGameBoard(const Position& position);
+
+/**
+ * @param board any bitboard
+ * @return the number of set bits (discs) in the bitboard
+ */
+int CountDiscs(uint64_t board);
+
+/**
+ * @param board a non-empty bitboard
+ * @return the index of the lowest set bit in the bitboard
+ */
+int LowestSquare(uint64_t board);
+
+/**
+ * Moves every disc one step in a direction, dropping discs that would leave
+ * the board.
+ *
+ * @param board the discs to move
+ * @param direction the direction, from 0 to kNumDirections - 1
+ * @return the moved discs
+ */
+uint64_t Shift(uint64_t board, int direction);
+
+/**
+ * Generates every legal move for the side owning own at once.
+ *
+ * @param own the discs of the side to move
+ * @param opponent the discs of the other side
+ * @return a bitmask with one bit set per legal move
+ */
+uint64_t GetMoveMask(uint64_t own, uint64_t opponent);
+
+/**
+ * @param position the position to generate moves for
+ * @return a bitmask of the legal moves of the side to move
+ */
+uint64_t GetMoveMask(const Position& position);
+
+/**
+ * Finds the discs that would be flipped by own playing on square. The move
+ * is not checked for legality; an illegal move simply flips nothing.
+ *
+ * @param own the discs of the side to move
+ * @param opponent the discs of the other side
+ * @param square the square being played
+ * @return a bitmask of the opponent discs that would be flipped
+ */
+uint64_t GetFlipMask(uint64_t own, uint64_t opponent, int square);
+
+/**
+ * Plays a move for the side to move and passes the turn. Playing kPassMove
+ * only passes the turn.
+ *
+ * @param position the position before the move
+ * @param square the square to play, or kPassMove
+ * @return the position after the move
+ */
+Position ApplyMove(const Position& position, int square);
+
+/**
+ * @param position any position
+ * @return whether neither side has a legal move
+ */
+bool IsTerminal(const Position& position);
+
+/**
+ * Picks one of the legal moves of the side to move uniformly at random.
+ *
+ * @param position the position to pick a move in
+ * @param rng the random number generator used to pick the move
+ * @return the square of the move, or kPassMove if there is no legal move
+ */
+int PickRandomMove(const Position& position, XorShift64& rng);
+
+/**
+ * Plays uniformly random legal moves (passing when forced) until neither side
+ * can move. Nothing is allocated, so this can be run millions of times.
+ *
+ * @param position the position to play out from
+ * @param rng the random number generator used to pick moves
+ * @return the final disc differential, black discs minus white discs
+ */
+int RandomPlayout(Position position, XorShift64& rng);
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_BITBOARD_H
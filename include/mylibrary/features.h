@@ -0,0 +1,138 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_FEATURES_H
+#define FINALPROJECT_FEATURES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+// The features of a position, all counted for the side to move ("own") and
+// the other side ("opponent"). The order is the column order of exports.
+enum Feature {
+  kOwnDiscs,
+  kOpponentDiscs,
+  kEmptySquares,
+  kOwnMobility,       // Number of legal moves
+  kOpponentMobility,
+  kOwnFrontier,       // Discs next to at least one empty square
+  kOpponentFrontier,
+  kOwnCorners,
+  kOpponentCorners,
+  kOwnXSquares,       // Discs diagonally next to an empty corner
+  kOpponentXSquares,
+  kOwnStable,         // Discs that can never be flipped
+  kOpponentStable,
+  kParity,            // 1 if an odd number of squares is empty
+  kNumFeatures
+};
+
+using FeatureVector = std::array<float, kNumFeatures>;
+
+/**
+ * Computes the feature vector of one position. Every feature is worked out
+ * on whole bitboards at once, 64 squares per operation.
+ *
+ * @param position the position to describe
+ * @return the features of the position, indexed by Feature
+ */
+FeatureVector ExtractFeatures(const Position& position);
+
+/**
+ * Computes the features of many positions into one row-major block, one row
+ * of kNumFeatures floats per position, without allocating.
+ *
+ * @param positions the positions to describe
+ * @param num_positions how many positions there are
+ * @param features where the rows are written, num_positions * kNumFeatures
+ * floats long
+ */
+void ExtractFeatures(const Position* positions, size_t num_positions,
+                     float* features);
+
+/**
+ * @param position any position
+ * @param is_white whether to count white's stable discs instead of black's
+ * @return a bitmask of the discs of that colour that can never be flipped
+ */
+uint64_t GetStableDiscs(const Position& position, bool is_white);
+
+/**
+ * Streams feature rows and their labels into two NumPy .npy files: one of
+ * shape (rows, kNumFeatures) and one of shape (rows,), both float32. Rows are
+ * buffered in fixed-size blocks, so memory use does not grow with the number
+ * of rows, and the array shapes are filled in by Finish.
+ */
+class FeatureExporter {
+ public:
+  /**
+   * Creates (or overwrites) both files.
+   *
+   * @param features_path the path of the features .npy file
+   * @param labels_path the path of the labels .npy file
+   * @throws std::runtime_error if either file cannot be opened
+   */
+  FeatureExporter(const std::string& features_path,
+                  const std::string& labels_path);
+
+  /**
+   * Finishes the files if Finish was not called.
+   */
+  ~FeatureExporter();
+
+  /**
+   * Adds the features of a position and its label.
+   *
+   * @param position the position to add
+   * @param label the label to train on, e.g. the final disc differential
+   */
+  void Add(const Position& position, float label);
+
+  /**
+   * Writes the buffered rows and the final array shapes, and closes the
+   * files. Nothing can be added afterwards.
+   */
+  void Finish();
+
+  /**
+   * @return how many rows were added so far
+   */
+  long long GetNumRows() const;
+
+ private:
+  // Writes the buffered rows to the files.
+  void Flush();
+
+  std::ofstream features_file_;
+  std::ofstream labels_file_;
+  std::vector<Position> pending_positions_;
+  std::vector<float> pending_labels_;
+  std::vector<float> feature_rows_;
+  long long num_rows_ = 0;
+  bool is_finished_ = false;
+};
+
+/**
+ * Plays random games and exports every position reached, labelled with the
+ * final disc differential of its game for the side to move.
+ *
+ * @param features_path the path of the features .npy file
+ * @param labels_path the path of the labels .npy file
+ * @param num_games how many games to play
+ * @param seed the seed of the random games
+ * @return how many positions were exported
+ */
+long long ExportRandomGames(const std::string& features_path,
+                            const std::string& labels_path,
+                            long long num_games, uint64_t seed);
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_FEATURES_H
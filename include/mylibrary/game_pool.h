@@ -0,0 +1,110 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_GAME_POOL_H
+#define FINALPROJECT_GAME_POOL_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mylibrary/bitboard.h"
+
+namespace othello {
+
+/**
+ * A fixed-capacity arena of game states for the match server. Every game is
+ * allocated up front, so a game costs the same few dozen bytes whether the
+ * server hosts one game or its full capacity, and creating or ending a game
+ * only touches the heap when an owner id larger than any before shows up.
+ *
+ * The games of each owner are chained into a list through their slots, so
+ * ending all of an owner's games costs as much as the games it has, not a
+ * scan of the whole pool.
+ *
+ * A game id combines the slot of the game with a generation counter that
+ * changes every time the slot is reused, so a finished game's id cannot reach
+ * the game that replaced it.
+ */
+class GamePool {
+ public:
+  // The most games a pool can hold. The low 20 bits of a game id are its
+  // slot and the rest its generation; the last slot is left out so that no
+  // game id can ever equal kNoGame.
+  static const uint32_t kMaxCapacity = (1u << 20) - 1;
+  // Returned by Create when the pool is full.
+  static const uint32_t kNoGame = 0xFFFFFFFF;
+
+  /**
+   * @param capacity how many games can exist at once, at most kMaxCapacity
+   * @throws std::runtime_error if the capacity is too large
+   */
+  explicit GamePool(uint32_t capacity);
+
+  /**
+   * Starts a game from the initial position.
+   *
+   * @param owner who the game belongs to, e.g. a connection's file
+   * descriptor. Owners are non-negative and should be small, as the pool
+   * keeps a list head for every owner id up to the largest one seen.
+   * @return the id of the new game, or kNoGame if the pool is full or the
+   * owner is negative
+   */
+  uint32_t Create(int owner);
+
+  /**
+   * @param game_id the id of a game
+   * @param owner who is asking for the game
+   * @return the position of the game, or nullptr if the game has ended or
+   * belongs to someone else
+   */
+  logic::Position* Find(uint32_t game_id, int owner);
+
+  /**
+   * Ends a game, making its slot free for a new one. Unknown ids are ignored.
+   *
+   * @param game_id the id of the game to end
+   */
+  void Release(uint32_t game_id);
+
+  /**
+   * Ends every game of an owner, e.g. when a connection closes.
+   *
+   * @param owner the owner whose games are ended
+   */
+  void ReleaseAll(int owner);
+
+  /**
+   * @return how many games exist
+   */
+  uint32_t GetNumGames() const;
+
+  /**
+   * @return how many games can exist at once
+   */
+  uint32_t GetCapacity() const;
+
+ private:
+  struct Slot {
+    logic::Position position;
+    int owner = -1; // -1 while the slot is free
+    uint32_t generation = 0;
+    uint32_t next_free = kNoGame;
+    // The owner's games before and after this one, while the slot is taken
+    uint32_t previous_owned = kNoGame;
+    uint32_t next_owned = kNoGame;
+  };
+
+  // Finds the slot of a game that still exists, or nullptr
+  Slot* FindSlot(uint32_t game_id);
+
+  std::unique_ptr<Slot[]> slots_;
+  uint32_t capacity_;
+  uint32_t first_free_;
+  // The slot of the most recently created game of each owner, or kNoGame
+  std::vector<uint32_t> first_owned_;
+  uint32_t num_games_ = 0;
+};
+
+}  // namespace othello
+
+#endif  // FINALPROJECT_GAME_POOL_H
@@ -0,0 +1,153 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_GAME_SESSION_H
+#define FINALPROJECT_GAME_SESSION_H
+
+#include <cstddef>
+
+#include "mylibrary/bitboard.h"
+#include "mylibrary/move_history.h"
+
+namespace logic {
+
+/**
+ * What a click on the board did, so the app can play sounds, update the
+ * leaderboard and restart the analysis.
+ */
+struct ClickResult {
+  bool is_move_played = false;
+  // Only set by the move that first ended the game. Undoing the last move
+  // and playing it again does not end the game a second time.
+  bool is_game_over = false;
+};
+
+/**
+ * The state of one game as the app shows it: the game board, the hover-over
+ * board, the valid moves, the scores and the move history. This is everything
+ * that clicking and hovering change, kept apart from any windowing code so it
+ * can also be driven without a window, e.g. by the input replay.
+ */
+class GameSession {
+ public:
+  /**
+   * Starts a game from the initial position.
+   */
+  GameSession();
+
+  /**
+   * Clears the board and the move history and starts a new game, whose end
+   * is reported again.
+   */
+  void Reset();
+
+  /**
+   * Starts the game from any position, with an empty move history.
+   *
+   * @param position the position to start from
+   */
+  void SetPosition(const Position& position);
+
+  /**
+   * Plays a move for the current player if x,y is a valid move, flipping
+   * pieces, updating the scores and handing the turn over (or back, if the
+   * other player has to pass). Anything else is ignored.
+   *
+   * @param x_tile_coordinate_ the x coordinate of the clicked tile
+   * @param y_tile_coordinate_ the y coordinate of the clicked tile
+   * @return whether a move was played and whether it ended the game
+   */
+  ClickResult Click(int x_tile_coordinate_, int y_tile_coordinate_);
+
+  /**
+   * Fills the hover-over board with what the game board would look like if
+   * the current player played on x,y, or clears it if x,y is not a valid
+   * move. This does not allocate, as it runs on every mouse movement.
+   *
+   * @param x_tile_coordinate_ the x coordinate of the tile under the mouse
+   * @param y_tile_coordinate_ the y coordinate of the tile under the mouse
+   */
+  void Hover(int x_tile_coordinate_, int y_tile_coordinate_);
+
+  /**
+   * Takes back the last move.
+   *
+   * @return false if there was no move to take back
+   */
+  bool Undo();
+
+  /**
+   * Plays the last move that was taken back again.
+   *
+   * @return false if there was no move to play again
+   */
+  bool Redo();
+
+  /**
+   * Moves the game to the position after the given number of moves.
+   *
+   * @param ply the number of moves from the start of the game
+   */
+  void JumpToPly(size_t ply);
+
+  const vector<vector<string>>& GetGameBoard() const;
+  const vector<vector<string>>& GetPotentialGameBoard() const;
+  const vector<pair<int, int>>& GetValidMoves() const;
+  const MoveHistory& GetHistory() const;
+
+  /**
+   * @return the position the game started from, before any move of the
+   * history
+   */
+  const Position& GetStartPosition() const;
+  bool IsWhiteTurn() const;
+  int GetBlackScore() const;
+  int GetWhiteScore() const;
+
+  /**
+   * This is worked out once after every move, so it is cheap to call every
+   * frame.
+   *
+   * @return whether neither player has a valid move left
+   */
+  bool IsGameOver() const;
+
+  /**
+   * @return "black" if black is ahead, "white" if white is ahead, and "tie"
+   * otherwise
+   */
+  string GetWinner() const;
+
+ private:
+  // Updates the scores after the current player placed a piece, using only
+  // the number of pieces the move flipped.
+  void UpdateScores(int num_flipped);
+
+  // Counts the scores from the board, for when it changed by more than one
+  // move.
+  void CountScores();
+
+  // Updates the valid moves, scores and game over flag after the board was
+  // moved to another ply, and clears the hover-over board.
+  void RefreshAfterHistoryChange();
+
+  // Empties every tile of the hover-over board.
+  void ClearPotentialGameBoard();
+
+  vector<vector<string>> game_board_;
+  // The game board as it would be if the hovered-over move was played
+  vector<vector<string>> potential_game_board_;
+  vector<pair<int, int>> valid_moves_;
+  MoveHistory history_;
+  Position start_position_;
+  bool is_white_turn_ = false;
+  bool is_game_over_ = false;
+  // Set once a click reported the end of the game, and cleared only when a
+  // new game starts, so every game's result is reported once
+  bool is_result_reported_ = false;
+  int black_score_ = 0;
+  int white_score_ = 0;
+};
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_GAME_SESSION_H
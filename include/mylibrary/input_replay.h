@@ -0,0 +1,153 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_INPUT_REPLAY_H
+#define FINALPROJECT_INPUT_REPLAY_H
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mylibrary/bitboard.h"
+#include "mylibrary/game_session.h"
+
+namespace logic {
+
+// The inputs that change a GameSession. Mouse events carry window pixel
+// coordinates; the others carry none.
+enum class InputEventType {
+  kMouseDown,
+  kMouseMove,
+  kReset,
+  kUndo,
+  kRedo,
+  kJumpToStart,
+  kJumpToEnd
+};
+
+struct InputEvent {
+  // Microseconds since the recording started
+  long long time_us = 0;
+  InputEventType type = InputEventType::kMouseMove;
+  int x = 0;
+  int y = 0;
+};
+
+/**
+ * A recorded input session: the game as it was when recording started, the
+ * tile size used to turn pixels into board coordinates, and every event in
+ * order. The game is kept as its start position plus every move of its
+ * history, undone ones included, so undo and redo replay like they happened.
+ */
+struct InputRecording {
+  Position start;
+  // The squares of the moves in the game's history, and how many of them
+  // were played (not undone) when recording started
+  std::vector<int> history;
+  size_t ply = 0;
+  int tile_length = 1;
+  std::vector<InputEvent> events;
+};
+
+/**
+ * Writes timestamped input events to a text file as they happen, one event
+ * per line, so a session played in the app can be replayed without a window.
+ */
+class InputRecorder {
+ public:
+  /**
+   * Creates (or overwrites) the recording file, saves the game as it is
+   * now, and starts the clock.
+   *
+   * @param path the path of the recording file
+   * @param session the game being recorded
+   * @param tile_length the length of a board tile in pixels
+   * @throws std::runtime_error if the file cannot be opened
+   */
+  InputRecorder(const std::string& path, const GameSession& session,
+                int tile_length);
+
+  /**
+   * Appends an event, timestamped with the time since construction.
+   *
+   * @param type what kind of event happened
+   * @param x the x pixel coordinate of a mouse event
+   * @param y the y pixel coordinate of a mouse event
+   */
+  void Record(InputEventType type, int x = 0, int y = 0);
+
+  /**
+   * @return how many events were recorded
+   */
+  size_t GetNumEvents() const;
+
+ private:
+  std::ofstream file_;
+  std::chrono::steady_clock::time_point start_time_;
+  size_t num_events_ = 0;
+};
+
+/**
+ * Reads a file written by InputRecorder.
+ *
+ * @param path the path of the recording file
+ * @return the recording
+ * @throws std::runtime_error if the file cannot be read or is malformed
+ */
+InputRecording ReadInputRecording(const std::string& path);
+
+/**
+ * Puts a game session in the state the recorded game was in when recording
+ * started, move history included.
+ *
+ * @param session the game session to change
+ * @param recording the recording to start replaying
+ */
+void RestoreRecordedGame(GameSession& session,
+                         const InputRecording& recording);
+
+/**
+ * Passes one event to a game session the same way the app does.
+ *
+ * @param session the game session to change
+ * @param event the event to apply
+ * @param tile_length the length of a board tile in pixels
+ * @return whether the event played a move
+ */
+bool ApplyInputEvent(GameSession& session, const InputEvent& event,
+                     int tile_length);
+
+// The distribution of the time taken to handle one kind of event.
+struct LatencyStats {
+  size_t count = 0;
+  double mean_us = 0;
+  double p50_us = 0;
+  double p90_us = 0;
+  double p99_us = 0;
+  double max_us = 0;
+};
+
+struct ReplayReport {
+  LatencyStats clicks;
+  LatencyStats hovers;
+  // Resets and moves through the history
+  LatencyStats others;
+  long long moves_played = 0;
+  double seconds = 0;
+};
+
+/**
+ * Feeds a recording through a fresh GameSession as fast as possible, timing
+ * how long each event takes to handle. No window is opened and the recorded
+ * timestamps are not waited for, so the result depends only on the events.
+ *
+ * @param recording the events to replay
+ * @param repetitions how many times to replay the whole recording
+ * @return the latency distributions of each kind of event
+ */
+ReplayReport ReplayInput(const InputRecording& recording, int repetitions);
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_INPUT_REPLAY_H
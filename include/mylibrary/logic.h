@@ -5,6 +5,8 @@
 #ifndef FINALPROJECT_LOGIC_H
 #define FINALPROJECT_LOGIC_H
 
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -24,6 +26,10 @@ namespace logic {
 const vector<int> kXChange{-1, 0, 1, -1, 1, -1, 0, 1};
 const vector<int> kYChange{-1, -1, -1, 0, 0, 1, 1, 1};
 const int kBoardSize = 8; // The size of the board (8x8)
+// There can never be more valid moves than squares on the board
+const int kMaxMoves = kBoardSize * kBoardSize;
+// A fixed-capacity list of x,y move coordinates that lives on the stack
+using MoveBuffer = std::array<pair<int, int>, kMaxMoves>;
 
 /**
  * This method flipped the appropriate pieces if the user committed a valid
@@ -40,6 +46,21 @@ vector<vector<string>> FlipPieces(int& x_tile_coordinate_,
                                   int& y_tile_coordinate_, bool is_white_turn_,
                                   vector<vector<string>> game_board_);
 
+/**
+ * This method does the same as FlipPieces, but flips the pieces on the game
+ * board that is passed in instead of on a copy. It does not allocate any
+ * memory, so it can be used on every mouse movement.
+ *
+ * @param x_tile_coordinate_ the x-coordinate of the move the player committed
+ * @param y_tile_coordinate_ the y-coordinate of the move the player committed
+ * @param is_white_turn_ the boolean indicating if it's a white turn or not
+ * @param game_board_ the game board whose pieces are flipped
+ * @return the number of pieces that were flipped
+ */
+int FlipPiecesInPlace(int x_tile_coordinate_, int y_tile_coordinate_,
+                      bool is_white_turn_,
+                      vector<vector<string>>& game_board_);
+
 /**
  * This method checks if a given move is in the bounds of the board (positions
  * 0 through 7) on the x and y. It is used several times as a utility method.
@@ -77,6 +98,40 @@ bool IsMoveValid(int& x_tile_coordinate_, int& y_tile_coordinate_,
 vector<pair<int, int>> GetValidMoves(vector<vector<string>>& game_board_,
                                      bool is_white_turn_);
 
+/**
+ * This method finds the same valid moves as the method above, in the same
+ * order, but writes them into a buffer owned by the caller instead of
+ * allocating a new vector.
+ *
+ * @param game_board_ the current state of the game board
+ * @param is_white_turn_ whether it is white's turn or not
+ * @param moves the buffer the x,y coordinates of the valid moves are written to
+ * @return the number of valid moves written to the buffer
+ */
+size_t GetValidMoves(const vector<vector<string>>& game_board_,
+                     bool is_white_turn_, MoveBuffer& moves);
+
+/**
+ * This method finds the valid moves as a bitmask, where bit x * 8 + y is set
+ * if x,y is a valid move. It does not allocate any memory.
+ *
+ * @param game_board_ the current state of the game board
+ * @param is_white_turn_ whether it is white's turn or not
+ * @return a bitmask with one bit set for each valid move
+ */
+uint64_t GetValidMoveMask(const vector<vector<string>>& game_board_,
+                          bool is_white_turn_);
+
+/**
+ * This method checks if the game is over, which happens when neither player
+ * has a valid move. This can happen before the board is full, so counting the
+ * pieces on the board is not enough.
+ *
+ * @param game_board_ the current state of the game board
+ * @return whether the game is over (true) or not (false)
+ */
+bool IsGameOver(const vector<vector<string>>& game_board_);
+
 }
 
 #endif  // FINALPROJECT_LOGIC_H
@@ -0,0 +1,50 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_MATCH_LOAD_H
+#define FINALPROJECT_MATCH_LOAD_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace othello {
+
+struct LoadTestOptions {
+  // Connects to this Unix socket if set, and to host:port over TCP if not
+  std::string unix_path;
+  std::string host = "127.0.0.1";
+  uint16_t port = 0;
+  // Each connection runs on its own thread and keeps this many games going,
+  // with one move in flight per game
+  int connections = 4;
+  int games_per_connection = 256;
+  std::chrono::milliseconds duration{5000};
+  uint64_t seed = 1;
+};
+
+struct LoadTestReport {
+  long long moves = 0;
+  long long games_finished = 0;
+  double seconds = 0;
+  double moves_per_second = 0;
+  // From sending a move to receiving the server's answer
+  double p50_latency_us = 0;
+  double p99_latency_us = 0;
+  double max_latency_us = 0;
+};
+
+/**
+ * Plays random games against a MatchServer as fast as it answers. Every
+ * connection sends one move for each of its games, reads the answers, and
+ * starts a new game in place of each one that ended, until the time is up.
+ *
+ * @param options where to connect and how much load to generate
+ * @return the throughput and latency seen by the clients
+ * @throws std::runtime_error if a connection fails or the server answers a
+ * request with an error
+ */
+LoadTestReport RunLoadTest(const LoadTestOptions& options);
+
+}  // namespace othello
+
+#endif  // FINALPROJECT_MATCH_LOAD_H
@@ -0,0 +1,100 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_MATCH_PROTOCOL_H
+#define FINALPROJECT_MATCH_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mylibrary/bitboard.h"
+
+namespace othello {
+
+// The binary protocol spoken between match clients and the MatchServer. Every
+// message starts with its type byte and has a fixed size, and all integers
+// are little-endian, so messages can be framed without any length prefix.
+//
+//   CreateGame  client -> server  type, tag                       5 bytes
+//   PlayMove    client -> server  type, tag, game id, square     10 bytes
+//   GameUpdate  server -> client  type, tag, game id, status,
+//                                 flags, black, white            27 bytes
+//
+// The tag is chosen by the client and echoed in the GameUpdate answering the
+// request, so many requests can be in flight on one connection.
+enum MessageType : uint8_t {
+  kCreateGame = 1,
+  kPlayMove = 2,
+  kGameUpdate = 3
+};
+
+enum MatchStatus : uint8_t {
+  kOk = 0,
+  kIllegalMove = 1,
+  kUnknownGame = 2,
+  kServerFull = 3
+};
+
+const size_t kCreateGameSize = 5;
+const size_t kPlayMoveSize = 10;
+const size_t kGameUpdateSize = 27;
+const size_t kMaxMessageSize = kGameUpdateSize;
+
+// A CreateGame or PlayMove message. game_id and square are only used by
+// PlayMove.
+struct MatchRequest {
+  MessageType type = kCreateGame;
+  uint32_t tag = 0;
+  uint32_t game_id = 0;
+  uint8_t square = 0;
+};
+
+// The server's answer to a request: the game's position after it, with the
+// side to move. Passes are played by the server, so the side to move always
+// has a legal move unless the game is over.
+struct GameUpdate {
+  uint32_t tag = 0;
+  uint32_t game_id = 0;
+  MatchStatus status = kOk;
+  bool is_game_over = false;
+  logic::Position position;
+};
+
+/**
+ * @param request the request to encode
+ * @param out where the message is written, at least kMaxMessageSize bytes
+ * @return the number of bytes written
+ */
+size_t EncodeRequest(const MatchRequest& request, uint8_t* out);
+
+/**
+ * Decodes the request at the start of a buffer.
+ *
+ * @param data the received bytes
+ * @param size how many bytes were received
+ * @param request set to the decoded request
+ * @return the number of bytes used, or 0 if the message is not complete yet
+ * @throws std::runtime_error if the bytes are not a request
+ */
+size_t DecodeRequest(const uint8_t* data, size_t size, MatchRequest& request);
+
+/**
+ * @param update the update to encode
+ * @param out where the message is written, at least kGameUpdateSize bytes
+ * @return the number of bytes written
+ */
+size_t EncodeGameUpdate(const GameUpdate& update, uint8_t* out);
+
+/**
+ * Decodes the game update at the start of a buffer.
+ *
+ * @param data the received bytes
+ * @param size how many bytes were received
+ * @param update set to the decoded update
+ * @return the number of bytes used, or 0 if the message is not complete yet
+ * @throws std::runtime_error if the bytes are not a game update
+ */
+size_t DecodeGameUpdate(const uint8_t* data, size_t size, GameUpdate& update);
+
+}  // namespace othello
+
+#endif  // FINALPROJECT_MATCH_PROTOCOL_H
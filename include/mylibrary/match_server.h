@@ -0,0 +1,160 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_MATCH_SERVER_H
+#define FINALPROJECT_MATCH_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mylibrary/game_pool.h"
+#include "mylibrary/match_protocol.h"
+#include "mylibrary/scoreboard.h"
+
+namespace othello {
+
+struct MatchServerOptions {
+  // How many games can be played at once over all connections
+  uint32_t max_games = 65536;
+  // Finished games are written to the scoreboard in batches of this many,
+  // or once the oldest unwritten game is this old. A batch the scoreboard
+  // fails to take is retried after the same interval.
+  size_t score_batch_size = 256;
+  std::chrono::milliseconds score_flush_interval{100};
+  // While the scoreboard keeps failing, at most this many finished games
+  // wait for it; older ones are dropped and counted
+  size_t max_pending_scores = 1 << 16;
+  // A connection is not read from while more than this many bytes of
+  // answers are waiting to be sent to it
+  size_t max_pending_output = 1 << 20;
+};
+
+struct MatchServerStats {
+  uint64_t connections = 0;
+  uint64_t games_created = 0;
+  uint64_t moves_played = 0;
+  uint64_t games_finished = 0;
+  // Finished games that never reached the scoreboard because it kept failing
+  uint64_t scores_dropped = 0;
+};
+
+/**
+ * Hosts many Othello games at once for clients connected over TCP or Unix
+ * sockets, speaking the protocol in match_protocol.h. One thread serves every
+ * connection with epoll; each game lives in a GamePool, moves are checked
+ * with the bitboard rules, and finished games are added to the scoreboard in
+ * batches. Only available on Linux.
+ */
+class MatchServer {
+ public:
+  /**
+   * @param scoreboard where finished games are recorded; only used from the
+   * thread calling Run
+   * @param options the limits of the server
+   * @throws std::runtime_error if epoll is not available
+   */
+  explicit MatchServer(Scoreboard& scoreboard,
+                       const MatchServerOptions& options =
+                           MatchServerOptions());
+
+  /**
+   * Closes every connection and listening socket.
+   */
+  ~MatchServer();
+
+  MatchServer(const MatchServer&) = delete;
+  MatchServer& operator=(const MatchServer&) = delete;
+
+  /**
+   * Accepts TCP connections on the loopback interface.
+   *
+   * @param port the port to listen on, or 0 for any free port
+   * @return the port being listened on
+   * @throws std::runtime_error if the socket cannot be set up
+   */
+  uint16_t ListenTcp(uint16_t port);
+
+  /**
+   * Accepts connections on a Unix socket, replacing any file at the path.
+   *
+   * @param path the path of the socket
+   * @throws std::runtime_error if the socket cannot be set up
+   */
+  void ListenUnix(const std::string& path);
+
+  /**
+   * Serves connections until Stop is called, then writes any finished games
+   * that are still waiting to the scoreboard. Scoreboard errors are logged
+   * and retried without interrupting the games.
+   *
+   * @throws std::runtime_error if waiting for events fails
+   */
+  void Run();
+
+  /**
+   * Makes Run return soon. Can be called from any thread.
+   */
+  void Stop();
+
+  /**
+   * @return the totals since the server was created; can be called from any
+   * thread
+   */
+  MatchServerStats GetStats() const;
+
+ private:
+  struct Connection;
+
+  void AddToEpoll(int fd, uint32_t events);
+  // How long Run may sleep before a timer of the server is due, or -1
+  int GetWaitTimeout() const;
+  void Accept(int listen_fd);
+  // Stops or resumes waiting for connections on every listening socket
+  void SetAccepting(bool is_accepting);
+  void HandleReadable(int fd);
+  void HandleRequest(int fd, Connection& connection,
+                     const MatchRequest& request);
+  // Sends as much waiting output as the socket takes; false on error
+  bool SendOutput(int fd, Connection& connection);
+  // Reads from a connection only while its output is not backed up, and
+  // waits for it to be writable while output is waiting
+  void UpdateEvents(int fd, Connection& connection);
+  void Close(int fd);
+  void QueueScore(const logic::Position& final_position);
+  // Writes the waiting scores, keeping them for a retry if that fails
+  void FlushScores();
+
+  Scoreboard& scoreboard_;
+  MatchServerOptions options_;
+  GamePool games_;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1; // An eventfd that Stop writes to
+  std::vector<int> listen_fds_;
+  std::vector<std::string> unix_paths_;
+  // Cleared while accepting fails, e.g. because the process is out of file
+  // descriptors, until a connection closes or the retry time is reached
+  bool is_accepting_ = true;
+  std::chrono::steady_clock::time_point accept_retry_time_;
+  std::chrono::steady_clock::time_point last_accept_error_log_;
+  // Indexed by file descriptor
+  std::vector<std::unique_ptr<Connection>> connections_;
+  std::vector<uint8_t> read_buffer_;
+  std::vector<ScoreEntry> pending_scores_;
+  // When the waiting scores are next due to be written
+  std::chrono::steady_clock::time_point oldest_pending_score_;
+  bool is_scoreboard_failing_ = false;
+  std::atomic<bool> is_stopping_{false};
+  std::atomic<uint64_t> num_connections_{0};
+  std::atomic<uint64_t> num_games_created_{0};
+  std::atomic<uint64_t> num_moves_played_{0};
+  std::atomic<uint64_t> num_games_finished_{0};
+  std::atomic<uint64_t> num_scores_dropped_{0};
+};
+
+}  // namespace othello
+
+#endif  // FINALPROJECT_MATCH_SERVER_H
@@ -0,0 +1,155 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_MCTS_H
+#define FINALPROJECT_MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+/**
+ * Numbers describing the last search, so that engine speed and tree size can
+ * be compared between machines and settings.
+ */
+struct MctsStats {
+  long long playouts = 0;
+  double seconds = 0;
+  double playouts_per_second = 0;
+  size_t nodes_used = 0;
+  size_t bytes_per_node = 0;
+  size_t bytes_used = 0;
+};
+
+/**
+ * A Monte Carlo Tree Search player built on the bitboard rules. All threads
+ * share one tree (tree parallelization); each thread adds a virtual loss to
+ * the nodes it walks through so that the threads spread over different
+ * branches. Nodes live in a fixed-size arena allocated once in the
+ * constructor, and the subtree of the move actually played is kept between
+ * searches.
+ */
+class MctsEngine {
+ public:
+  /**
+   * @param max_nodes the number of nodes in the arena; once it is full the
+   * search keeps running playouts but stops growing the tree
+   * @param num_threads the number of search threads, at least 1
+   * @param seed the seed of the playout random number generators
+   */
+  MctsEngine(size_t max_nodes, int num_threads, uint64_t seed);
+
+  /**
+   * Sets the position to search from. The tree is kept if the position is
+   * the one the engine is already at, and thrown away otherwise.
+   *
+   * @param position the position to search from
+   */
+  void SetPosition(const Position& position);
+
+  /**
+   * @return the position the engine searches from
+   */
+  const Position& GetPosition() const;
+
+  /**
+   * Searches until the given number of playouts have been run.
+   *
+   * @param playouts the number of playouts to add to the tree
+   * @return the best move found, or kPassMove if the side to move must pass
+   */
+  int Search(long long playouts);
+
+  /**
+   * Searches until the think time has been used up.
+   *
+   * @param think_time how long to search for
+   * @return the best move found, or kPassMove if the side to move must pass
+   */
+  int SearchFor(std::chrono::milliseconds think_time);
+
+  /**
+   * Plays a move on the engine's position. If the move was already searched,
+   * its subtree becomes the new tree so that its playouts are not wasted.
+   *
+   * @param square the square played, or kPassMove
+   */
+  void Advance(int square);
+
+  /**
+   * @return how many playouts were spent on the current root so far,
+   * including the ones reused from earlier searches
+   */
+  long long GetRootVisits() const;
+
+  /**
+   * @return the statistics of the last search
+   */
+  const MctsStats& GetStats() const;
+
+ private:
+  // Values of Node::state. A node is expanded by exactly one thread; other
+  // threads that reach it while it is expanding run a playout from it.
+  static const uint8_t kUnexpanded = 0;
+  static const uint8_t kExpanding = 1;
+  static const uint8_t kExpanded = 2;
+
+  struct Node {
+    // Visits include the virtual losses of threads currently below the node
+    std::atomic<int32_t> visits{0};
+    // Half-points (win = 2, draw = 1) for the side that played move
+    std::atomic<int32_t> score{0};
+    // Children are stored next to each other starting at first_child
+    std::atomic<uint32_t> first_child{0};
+    std::atomic<uint8_t> state{kUnexpanded};
+    uint8_t num_children = 0;
+    uint8_t move = 0;
+  };
+
+  // Runs playouts on the calling thread until the shared budget or the
+  // deadline is used up.
+  void Worker(int thread_index, long long playouts,
+              std::chrono::steady_clock::time_point deadline);
+
+  // Runs one selection, expansion, playout and backpropagation step.
+  void RunIteration(XorShift64& rng);
+
+  // Creates the children of node, returning false if another thread is
+  // already doing so or if the arena is full.
+  bool Expand(uint32_t node, const Position& position);
+
+  // Picks the child of node with the highest UCT value.
+  uint32_t SelectChild(uint32_t node) const;
+
+  // Runs the search on every thread and fills in stats_.
+  int RunSearch(long long playouts,
+                std::chrono::steady_clock::time_point deadline);
+
+  // Returns the most visited move of the root.
+  int BestMove() const;
+
+  // Throws the tree away, leaving only an unexpanded root.
+  void ResetTree();
+
+  size_t max_nodes_;
+  int num_threads_;
+  uint64_t seed_;
+  uint64_t searches_run_ = 0;
+  Position root_position_;
+  std::unique_ptr<Node[]> nodes_;
+  // The arena that subtrees are copied into by Advance
+  std::unique_ptr<Node[]> spare_nodes_;
+  std::atomic<uint32_t> nodes_used_{0};
+  std::atomic<long long> playouts_started_{0};
+  std::atomic<long long> playouts_finished_{0};
+  MctsStats stats_;
+};
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_MCTS_H
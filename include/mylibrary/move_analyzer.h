@@ -0,0 +1,112 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_MOVE_ANALYZER_H
+#define FINALPROJECT_MOVE_ANALYZER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mylibrary/analysis_cache.h"
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+/**
+ * Scores every legal move of a position in the background on a pool of
+ * worker threads. Each move is scored by random playouts, and its estimate
+ * is published after every batch of playouts, so a caller polling the scores
+ * sees them appear and sharpen progressively. Asking for a new position
+ * cancels all work on the old one.
+ *
+ * Reading a score never blocks: scores are stored in atomics tagged with the
+ * position they belong to, so the render loop can poll them every frame.
+ *
+ * With an analysis cache, finished scores are stored as playout analyses of
+ * the position after the move, and moves whose score is already there with
+ * as many playouts are not run again.
+ */
+class MoveAnalyzer {
+ public:
+  /**
+   * Starts the worker threads.
+   *
+   * @param num_threads the number of worker threads, at least 1
+   * @param playouts_per_move how many playouts go into a finished score
+   * @param cache where finished scores are looked up and stored, or null for
+   * no cache; it must outlive the analyzer
+   */
+  MoveAnalyzer(int num_threads, int playouts_per_move,
+               AnalysisCache* cache = nullptr);
+
+  /**
+   * Stops and joins the worker threads.
+   */
+  ~MoveAnalyzer();
+
+  MoveAnalyzer(const MoveAnalyzer&) = delete;
+  MoveAnalyzer& operator=(const MoveAnalyzer&) = delete;
+
+  /**
+   * Starts scoring the legal moves of a position, dropping any work that is
+   * still queued or running for the previous position. This returns right
+   * away.
+   *
+   * @param position the position whose moves should be scored
+   */
+  void Analyze(const Position& position);
+
+  /**
+   * Stops all work without starting on a new position.
+   */
+  void Cancel();
+
+  /**
+   * Reads the latest score of a move without waiting for the workers.
+   *
+   * @param square the square of the move, x * kBoardSize + y
+   * @param score set to the expected result for the side to move, from 0
+   * (certain loss) to 1 (certain win), if a score is available
+   * @return whether a score for the current position is available yet
+   */
+  bool TryGetScore(int square, float& score) const;
+
+ private:
+  struct Job {
+    Position position;
+    int square;
+    uint32_t generation;
+  };
+
+  // Takes jobs off the queue until the analyzer is destroyed.
+  void WorkerLoop();
+
+  // Runs the playouts of one job, publishing the score after every batch.
+  void RunJob(const Job& job);
+
+  // Stores a score unless a newer generation has already stored one.
+  void PublishScore(int square, uint32_t generation, float score);
+
+  int playouts_per_move_;
+  AnalysisCache* cache_;
+  // Bumped by every Analyze and Cancel, so workers can tell stale jobs. It
+  // starts at 1 so the zeroed scores do not belong to any position.
+  std::atomic<uint32_t> generation_{1};
+  // The generation in the high 32 bits and the score's float bits in the
+  // low 32 bits, so a score can never be read with the wrong position
+  std::atomic<uint64_t> scores_[kNumSquares];
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_changed_;
+  std::deque<Job> queue_;
+  bool is_stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_MOVE_ANALYZER_H
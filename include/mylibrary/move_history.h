@@ -0,0 +1,98 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_MOVE_HISTORY_H
+#define FINALPROJECT_MOVE_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+/**
+ * The moves of a game, kept as deltas rather than board snapshots. Each move
+ * stores the square played, the discs it flipped and whose turn it was before
+ * and after it, which is enough to step the game board in either direction
+ * without looking at the rest of the board. A whole game fits in about a
+ * kilobyte.
+ */
+class MoveHistory {
+ public:
+  /**
+   * Records a move played at the current ply. Any moves that were undone and
+   * not redone are forgotten, like in a text editor.
+   *
+   * @param before the position the move was played in
+   * @param square the square that was played
+   * @param is_white_turn_after whose turn it is after the move, which is the
+   * same side again if the opponent had to pass
+   */
+  void Record(const Position& before, int square, bool is_white_turn_after);
+
+  /**
+   * Takes back the last move on the game board.
+   *
+   * @param game_board_ the game board at the current ply
+   * @param is_white_turn_ set to whose turn it was before the move
+   * @return false if there was no move to take back
+   */
+  bool Undo(vector<vector<string>>& game_board_, bool& is_white_turn_);
+
+  /**
+   * Plays the last move that was taken back again.
+   *
+   * @param game_board_ the game board at the current ply
+   * @param is_white_turn_ set to whose turn it is after the move
+   * @return false if there was no move to play again
+   */
+  bool Redo(vector<vector<string>>& game_board_, bool& is_white_turn_);
+
+  /**
+   * Undoes or redoes moves until the game board is at the given ply, in time
+   * proportional to the number of plies between the two.
+   *
+   * @param ply the number of moves from the start of the game, clamped to
+   * the moves that have been recorded
+   * @param game_board_ the game board at the current ply
+   * @param is_white_turn_ set to whose turn it is at the new ply
+   */
+  void JumpToPly(size_t ply, vector<vector<string>>& game_board_,
+                 bool& is_white_turn_);
+
+  /**
+   * @return how many moves from the start of the game the board is at
+   */
+  size_t GetPly() const;
+
+  /**
+   * @return how many moves have been recorded, including undone ones
+   */
+  size_t GetNumPlies() const;
+
+  /**
+   * @param ply the number of moves before the move, less than GetNumPlies
+   * @return the square the move was played on
+   */
+  int GetSquare(size_t ply) const;
+
+  /**
+   * Forgets every move, for when a new game is started.
+   */
+  void Clear();
+
+ private:
+  struct MoveRecord {
+    uint64_t flipped;
+    uint8_t square;
+    bool was_white_turn;
+    bool is_white_turn_after;
+  };
+
+  vector<MoveRecord> moves_;
+  size_t ply_ = 0;
+};
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_MOVE_HISTORY_H
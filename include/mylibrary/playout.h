@@ -0,0 +1,51 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_PLAYOUT_H
+#define FINALPROJECT_PLAYOUT_H
+
+#include <array>
+#include <cstdint>
+
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+// The final disc differential of a game is between -64 and 64
+const int kMaxDiscDifferential = kNumSquares;
+const int kNumDiscDifferentials = 2 * kMaxDiscDifferential + 1;
+
+/**
+ * The outcome of a batch of random playouts. Wins, draws, losses and the disc
+ * differentials are all counted for the side to move in the starting position.
+ */
+struct PlayoutResult {
+  long long playouts = 0;
+  long long wins = 0;
+  long long draws = 0;
+  long long losses = 0;
+  // disc_differentials[d + kMaxDiscDifferential] counts the playouts that
+  // ended with the side to move d discs ahead
+  std::array<long long, kNumDiscDifferentials> disc_differentials{};
+  double seconds = 0;
+  double playouts_per_second = 0;
+};
+
+/**
+ * Plays random games from a position to the end on several threads. The
+ * playouts are split into fixed chunks that each have their own random
+ * number generator, derived from the seed and the chunk's index, so the
+ * result is the same for a given seed no matter how many threads run it.
+ *
+ * @param position the position every playout starts from
+ * @param num_playouts how many random games to play
+ * @param seed the seed the random games are derived from
+ * @param num_threads how many threads to use; 0 or less uses one thread per
+ * hardware core
+ * @return the counts of every outcome, and how fast they were played
+ */
+PlayoutResult PlayoutBatch(const Position& position, long long num_playouts,
+                           uint64_t seed, int num_threads);
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_PLAYOUT_H
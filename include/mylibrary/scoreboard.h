@@ -4,18 +4,71 @@
 
 #include <sqlite_modern_cpp.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace othello {
 
+// One row of the leaderboard.
+struct ScoreEntry {
+  std::string winner;
+  std::string loser;
+  int score;
+};
+
+// Totals for one player over every game on the leaderboard. Ties are stored
+// with the same name as winner and loser.
+struct PlayerStats {
+  int wins = 0;
+  int losses = 0;
+  int ties = 0;
+  int best_score = 0;
+};
+
 class Scoreboard {
  public:
-  // Creates a new leaderboard table if it doesn't already exist.
-  explicit Scoreboard(const std::string& db_path);
-  // Adds the winner, their score, and the loser to the leaderboard.
+  // How many of the highest scores are kept in memory by default.
+  static const size_t kDefaultTopK = 10;
+
+  // Creates a new leaderboard table if it doesn't already exist, and loads
+  // the leaderboard into memory so reads never have to query the database.
+  explicit Scoreboard(const std::string& db_path,
+                      size_t top_k = kDefaultTopK);
+  // Adds the winner, their score, and the loser to the leaderboard. The
+  // in-memory copy is only updated once the database insert has succeeded.
   void AddWinnerToScoreBoard(const std::string& winner,
       const std::string& loser, int score);
+  // Adds many games in a single database transaction, which costs about as
+  // much as adding one game. Either every game is added or, if an insert
+  // fails, none of them are.
+  void AddGamesToScoreBoard(const std::vector<ScoreEntry>& entries);
+
+  // Returns the highest scores from memory, highest first, at most top_k.
+  std::vector<ScoreEntry> GetTopScores() const;
+  // Returns the totals of a player from memory.
+  PlayerStats GetPlayerStats(const std::string& player) const;
+  // Returns the number of games on the leaderboard from memory.
+  size_t GetNumGames() const;
+
+  // The same reads as above, answered by querying the database directly.
+  // These are used to check that memory and database agree, and as the
+  // baseline in the leaderboard benchmark.
+  std::vector<ScoreEntry> QueryTopScores();
+  PlayerStats QueryPlayerStats(const std::string& player);
+  size_t QueryNumGames();
 
  private:
+  // Adds a game to the top scores heap and the player totals.
+  void AddToCache(const ScoreEntry& entry);
+
   sqlite::database db_;
+  size_t top_k_;
+  // A min-heap of the top_k_ highest scores, so the lowest of them is the
+  // one replaced when a higher score comes in.
+  std::vector<ScoreEntry> top_scores_;
+  std::unordered_map<std::string, PlayerStats> player_stats_;
+  size_t num_games_ = 0;
 };
 
 }  // namespace mylibrary
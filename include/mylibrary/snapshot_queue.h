@@ -0,0 +1,75 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_SNAPSHOT_QUEUE_H
+#define FINALPROJECT_SNAPSHOT_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+/**
+ * The state of one live game at one point in time.
+ */
+struct BoardSnapshot {
+  uint32_t game_id = 0;
+  Position position;
+  bool is_game_over = false;
+};
+
+/**
+ * A bounded lock-free queue of board snapshots. Any number of game threads
+ * can push while a viewer pops. Pushing never blocks or allocates: when the
+ * queue is full the snapshot is dropped, because a newer snapshot of the same
+ * game will follow soon and spectating must never slow the games down.
+ */
+class SnapshotQueue {
+ public:
+  /**
+   * @param capacity the most snapshots the queue holds, rounded up to a power
+   * of two
+   */
+  explicit SnapshotQueue(size_t capacity);
+
+  SnapshotQueue(const SnapshotQueue&) = delete;
+  SnapshotQueue& operator=(const SnapshotQueue&) = delete;
+
+  /**
+   * @param snapshot the snapshot to add
+   * @return false if the queue was full and the snapshot was dropped
+   */
+  bool TryPush(const BoardSnapshot& snapshot);
+
+  /**
+   * @param snapshot set to the oldest snapshot in the queue, if there is one
+   * @return false if the queue was empty
+   */
+  bool TryPop(BoardSnapshot& snapshot);
+
+  /**
+   * @return how many snapshots have been dropped because the queue was full
+   */
+  long long GetNumDropped() const;
+
+ private:
+  // A cell's sequence number tells whether it is ready to be written (equal
+  // to the write position) or read (one past the read position).
+  struct Cell {
+    std::atomic<size_t> sequence;
+    BoardSnapshot snapshot;
+  };
+
+  size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  std::atomic<size_t> write_position_{0};
+  std::atomic<size_t> read_position_{0};
+  std::atomic<long long> num_dropped_{0};
+};
+
+}  // namespace logic
+
+#endif  // FINALPROJECT_SNAPSHOT_QUEUE_H
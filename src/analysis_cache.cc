@@ -0,0 +1,298 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/analysis_cache.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace logic {
+
+namespace {
+
+// Marks a file as an analysis cache ("OTHCACH" and a format version)
+const uint64_t kMagic = 0x4F54484341434802ULL;
+// How many neighbouring slots a position may be stored in
+const size_t kProbeLength = 4;
+// Layout of a slot's data word: the score in the low 32 bits, then 22 bits
+// of depth, 7 bits of best move and the kind. The occupied bit keeps every
+// stored data word non-zero, so an empty slot never matches a key.
+const int kDepthShift = 32;
+const int kBestMoveShift = 54;
+const int kKindShift = 61;
+const uint64_t kOccupied = 1ULL << 63;
+const uint64_t kBestMoveBits = 0x7F;
+// Stands for kNoMove in the best move bits
+const uint64_t kNoMoveBits = kBestMoveBits;
+// Playout analyses are keyed apart from searches of the same position
+const uint64_t kPlayoutsKey = 0x3C79AC492BA7B653ULL;
+
+uint64_t Pack(const CachedAnalysis& analysis) {
+  const uint64_t depth = static_cast<uint64_t>(
+      std::min(std::max(analysis.depth, 0), AnalysisCache::kMaxDepth));
+  const uint64_t best_move =
+      analysis.best_move < 0 || analysis.best_move > kPassMove
+          ? kNoMoveBits : static_cast<uint64_t>(analysis.best_move);
+  const uint64_t kind = analysis.kind == AnalysisKind::kPlayouts ? 1 : 0;
+  return static_cast<uint32_t>(analysis.score) | depth << kDepthShift
+      | best_move << kBestMoveShift | kind << kKindShift | kOccupied;
+}
+
+CachedAnalysis Unpack(uint64_t data) {
+  CachedAnalysis analysis;
+  analysis.score = static_cast<int32_t>(static_cast<uint32_t>(data));
+  analysis.depth = static_cast<int>((data >> kDepthShift)
+                                    & AnalysisCache::kMaxDepth);
+  const uint64_t best_move = (data >> kBestMoveShift) & kBestMoveBits;
+  analysis.best_move =
+      best_move == kNoMoveBits ? kNoMove : static_cast<int>(best_move);
+  analysis.kind = (data >> kKindShift) & 1
+      ? AnalysisKind::kPlayouts : AnalysisKind::kSearch;
+  return analysis;
+}
+
+uint64_t GetKey(const Position& position, AnalysisKind kind) {
+  const uint64_t key = AnalysisCache::HashPosition(position);
+  if (kind == AnalysisKind::kSearch) {
+    return key;
+  }
+  const uint64_t playouts_key = key ^ kPlayoutsKey;
+  return playouts_key == 0 ? 1 : playouts_key;
+}
+
+}  // namespace
+
+AnalysisCache::AnalysisCache(const std::string& path, size_t num_slots) {
+  Map(path, std::max<size_t>(num_slots, kProbeLength));
+  const size_t file_slots = mapping_size_ < sizeof(Header)
+      ? 0 : (mapping_size_ - sizeof(Header)) / sizeof(Slot);
+  if (file_slots < kProbeLength
+      || mapping_size_ != sizeof(Header) + file_slots * sizeof(Slot)) {
+    Unmap();
+    throw std::runtime_error(path + " is not an analysis cache");
+  }
+
+  // Map holds the file lock, so a file with no header yet was just created
+  // by this process. The magic is published last, so a reader that sees it
+  // also sees the slot count.
+  const uint64_t magic = header_->magic.load(std::memory_order_acquire);
+  if (magic == 0) {
+    header_->num_slots.store(file_slots, std::memory_order_relaxed);
+    header_->magic.store(kMagic, std::memory_order_release);
+  } else if (magic != kMagic
+             || header_->num_slots.load(std::memory_order_relaxed)
+                 != file_slots) {
+    Unmap();
+    throw std::runtime_error(path + " is not an analysis cache");
+  }
+  num_slots_ = file_slots;
+  Unlock();
+}
+
+AnalysisCache::~AnalysisCache() {
+  Unmap();
+}
+
+#ifdef _WIN32
+
+void AnalysisCache::Map(const std::string& path, size_t num_slots) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("could not open " + path);
+  }
+  file_handle_ = file;
+  // Locks a byte past any real file size, so the lock never covers data
+  OVERLAPPED lock_range = {};
+  lock_range.Offset = MAXDWORD;
+  lock_range.OffsetHigh = MAXDWORD;
+  if (!LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &lock_range)) {
+    Unmap();
+    throw std::runtime_error("could not lock " + path);
+  }
+
+  LARGE_INTEGER file_size;
+  GetFileSizeEx(file, &file_size);
+  mapping_size_ = file_size.QuadPart > 0
+      ? static_cast<size_t>(file_size.QuadPart)
+      : sizeof(Header) + num_slots * sizeof(Slot);
+
+  // Mapping more than the file holds grows the file, zero-filled
+  const uint64_t size = mapping_size_;
+  HANDLE mapping = CreateFileMappingA(
+      file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+      static_cast<DWORD>(size), nullptr);
+  if (mapping == nullptr) {
+    Unmap();
+    throw std::runtime_error("could not map " + path);
+  }
+  mapping_handle_ = mapping;
+  mapping_ = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, mapping_size_);
+  if (mapping_ == nullptr) {
+    Unmap();
+    throw std::runtime_error("could not map " + path);
+  }
+  header_ = static_cast<Header*>(mapping_);
+  slots_ = reinterpret_cast<Slot*>(header_ + 1);
+}
+
+void AnalysisCache::Unlock() {
+  OVERLAPPED lock_range = {};
+  lock_range.Offset = MAXDWORD;
+  lock_range.OffsetHigh = MAXDWORD;
+  UnlockFileEx(file_handle_, 0, 1, 0, &lock_range);
+}
+
+void AnalysisCache::Unmap() {
+  if (mapping_ != nullptr) {
+    UnmapViewOfFile(mapping_);
+    mapping_ = nullptr;
+  }
+  if (mapping_handle_ != nullptr) {
+    CloseHandle(mapping_handle_);
+    mapping_handle_ = nullptr;
+  }
+  if (file_handle_ != nullptr) {
+    CloseHandle(file_handle_);
+    file_handle_ = nullptr;
+  }
+}
+
+#else
+
+void AnalysisCache::Map(const std::string& path, size_t num_slots) {
+  file_descriptor_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (file_descriptor_ < 0) {
+    throw std::runtime_error("could not open " + path);
+  }
+  // Closing the file in Unmap also releases the lock
+  if (flock(file_descriptor_, LOCK_EX) != 0) {
+    Unmap();
+    throw std::runtime_error("could not lock " + path);
+  }
+
+  struct stat file_stat;
+  if (fstat(file_descriptor_, &file_stat) != 0) {
+    Unmap();
+    throw std::runtime_error("could not read the size of " + path);
+  }
+  if (file_stat.st_size > 0) {
+    mapping_size_ = static_cast<size_t>(file_stat.st_size);
+  } else {
+    // Growing the file fills it with zeroes, which are empty slots
+    mapping_size_ = sizeof(Header) + num_slots * sizeof(Slot);
+    if (ftruncate(file_descriptor_,
+                  static_cast<off_t>(mapping_size_)) != 0) {
+      Unmap();
+      throw std::runtime_error("could not grow " + path);
+    }
+  }
+
+  void* mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, file_descriptor_, 0);
+  if (mapping == MAP_FAILED) {
+    Unmap();
+    throw std::runtime_error("could not map " + path);
+  }
+  mapping_ = mapping;
+  header_ = static_cast<Header*>(mapping_);
+  slots_ = reinterpret_cast<Slot*>(header_ + 1);
+}
+
+void AnalysisCache::Unlock() {
+  flock(file_descriptor_, LOCK_UN);
+}
+
+void AnalysisCache::Unmap() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+  }
+  if (file_descriptor_ >= 0) {
+    close(file_descriptor_);
+    file_descriptor_ = -1;
+  }
+}
+
+#endif
+
+const int AnalysisCache::kMaxDepth;
+
+bool AnalysisCache::Lookup(const Position& position, CachedAnalysis& analysis,
+                           AnalysisKind kind) const {
+  const uint64_t key = GetKey(position, kind);
+  const size_t num_slots = GetNumSlots();
+  const size_t start = static_cast<size_t>(key % num_slots);
+  for (size_t i = 0; i < kProbeLength; i++) {
+    const Slot& slot = slots_[(start + i) % num_slots];
+    const uint64_t data = slot.data.load(std::memory_order_acquire);
+    const uint64_t check = slot.check.load(std::memory_order_acquire);
+    // A slot that is being rewritten has words from two entries, which do
+    // not agree with any key
+    if (data != 0 && (check ^ data) == key) {
+      analysis = Unpack(data);
+      return true;
+    }
+  }
+  return false;
+}
+
+void AnalysisCache::Store(const Position& position,
+                          const CachedAnalysis& analysis) {
+  const uint64_t key = GetKey(position, analysis.kind);
+  const uint64_t new_data = Pack(analysis);
+  const size_t num_slots = GetNumSlots();
+  const size_t start = static_cast<size_t>(key % num_slots);
+
+  Slot* target = nullptr;
+  int target_depth = std::numeric_limits<int>::max();
+  for (size_t i = 0; i < kProbeLength; i++) {
+    Slot& slot = slots_[(start + i) % num_slots];
+    const uint64_t data = slot.data.load(std::memory_order_acquire);
+    const uint64_t check = slot.check.load(std::memory_order_acquire);
+    if (data != 0 && (check ^ data) == key) {
+      if (Unpack(data).depth > Unpack(new_data).depth) {
+        return; // Never replace a deeper analysis of the same position
+      }
+      target = &slot;
+      break;
+    }
+    // Empty slots count as the shallowest of all
+    const int depth = data == 0 ? -1 : Unpack(data).depth;
+    if (depth < target_depth) {
+      target = &slot;
+      target_depth = depth;
+    }
+  }
+
+  target->check.store(key ^ new_data, std::memory_order_release);
+  target->data.store(new_data, std::memory_order_release);
+}
+
+size_t AnalysisCache::GetNumSlots() const {
+  return num_slots_;
+}
+
+uint64_t AnalysisCache::HashPosition(const Position& position) {
+  const uint64_t kWhiteKey = 0xD6E8FEB86659FD93ULL;
+  const uint64_t kTurnKey = 0xA0761D6478BD642FULL;
+  uint64_t key = SplitMix64(position.black)
+      ^ SplitMix64(position.white ^ kWhiteKey);
+  if (position.is_white_turn) {
+    key ^= kTurnKey;
+  }
+  return key == 0 ? 1 : key; // Zero is what an empty slot decodes to
+}
+
+}  // namespace logic
@@ -0,0 +1,209 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/bitboard.h"
+
+namespace logic {
+
+namespace {
+
+// Bitboards with every square of the first (y == 0) or last (y == 7) column
+// set. Shifting a disc one step in y must not wrap into the next row.
+const uint64_t kFirstColumn = 0x0101010101010101ULL;
+const uint64_t kLastColumn = 0x8080808080808080ULL;
+
+// The bit offset of one step in each of the 8 directions, in the same order
+// as kXChange and kYChange (an offset of x * kBoardSize + y).
+const int kShifts[kNumDirections] = {-9, -1, 7, -8, 8, -7, 1, 9};
+// Squares that a step in each direction may land on. A step that changes y
+// must not wrap around into the first or last column of a neighbouring x.
+const uint64_t kShiftMasks[kNumDirections] = {
+    ~kLastColumn, ~kLastColumn, ~kLastColumn, ~0ULL,
+    ~0ULL, ~kFirstColumn, ~kFirstColumn, ~kFirstColumn};
+
+}  // namespace
+
+uint64_t SplitMix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t Shift(uint64_t board, int direction) {
+  const int shift = kShifts[direction];
+  const uint64_t shifted = shift > 0 ? board << shift : board >> -shift;
+  return shifted & kShiftMasks[direction];
+}
+
+XorShift64::XorShift64(uint64_t seed) : state_{SplitMix64(seed)} {
+  if (state_ == 0) {
+    state_ = 0x9E3779B97F4A7C15ULL; // xorshift must never hold a zero state
+  }
+}
+
+uint64_t XorShift64::Next() {
+  state_ ^= state_ >> 12;
+  state_ ^= state_ << 25;
+  state_ ^= state_ >> 27;
+  return state_ * 0x2545F4914F6CDD1DULL;
+}
+
+uint32_t XorShift64::NextBelow(uint32_t bound) {
+  // Multiply-shift maps 32 random bits onto [0, bound) without a division.
+  const uint64_t random_bits = Next() >> 32;
+  return static_cast<uint32_t>((random_bits * bound) >> 32);
+}
+
+Position InitialPosition() {
+  Position position;
+  // The same four starting discs that MyApp::SetInitialGameBoard places
+  position.white = (1ULL << (3 * kBoardSize + 3))
+      | (1ULL << (4 * kBoardSize + 4));
+  position.black = (1ULL << (3 * kBoardSize + 4))
+      | (1ULL << (4 * kBoardSize + 3));
+  position.is_white_turn = false;
+  return position;
+}
+
+Position ToPosition(const vector<vector<string>>& game_board_,
+                    bool is_white_turn_) {
+  Position position;
+  position.is_white_turn = is_white_turn_;
+  for (size_t i = 0; i < kBoardSize; i++) {
+    for (size_t j = 0; j < kBoardSize; j++) {
+      const uint64_t bit = 1ULL << (i * kBoardSize + j);
+      if (game_board_[i][j] == "black") {
+        position.black |= bit;
+      } else if (game_board_[i][j] == "white") {
+        position.white |= bit;
+      }
+    }
+  }
+  return position;
+}
+
+vector<vector<string>> ToGameBoard(const Position& position) {
+  vector<vector<string>> game_board(kBoardSize, vector<string>(kBoardSize));
+  for (size_t i = 0; i < kBoardSize; i++) {
+    for (size_t j = 0; j < kBoardSize; j++) {
+      const uint64_t bit = 1ULL << (i * kBoardSize + j);
+      if (position.black & bit) {
+        game_board[i][j] = "black";
+      } else if (position.white & bit) {
+        game_board[i][j] = "white";
+      }
+    }
+  }
+  return game_board;
+}
+
+int CountDiscs(uint64_t board) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(board);
+#else
+  board = board - ((board >> 1) & 0x5555555555555555ULL);
+  board = (board & 0x3333333333333333ULL)
+      + ((board >> 2) & 0x3333333333333333ULL);
+  board = (board + (board >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<int>((board * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+int LowestSquare(uint64_t board) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(board);
+#else
+  // The bits below the lowest set bit, counted.
+  return CountDiscs((board & (~board + 1)) - 1);
+#endif
+}
+
+uint64_t GetMoveMask(uint64_t own, uint64_t opponent) {
+  const uint64_t empty = ~(own | opponent);
+  uint64_t moves = 0;
+  for (int direction = 0; direction < kNumDirections; direction++) {
+    // A line can hold at most 6 opponent discs between the move and an own
+    // disc, so the run of opponent discs is extended 5 more times.
+    uint64_t run = Shift(own, direction) & opponent;
+    for (int i = 0; i < kBoardSize - 3; i++) {
+      run |= Shift(run, direction) & opponent;
+    }
+    moves |= Shift(run, direction) & empty;
+  }
+  return moves;
+}
+
+uint64_t GetMoveMask(const Position& position) {
+  return position.is_white_turn
+             ? GetMoveMask(position.white, position.black)
+             : GetMoveMask(position.black, position.white);
+}
+
+uint64_t GetFlipMask(uint64_t own, uint64_t opponent, int square) {
+  const uint64_t move = 1ULL << square;
+  if ((own | opponent) & move) {
+    return 0; // Occupied squares never flip anything
+  }
+  uint64_t flips = 0;
+  for (int direction = 0; direction < kNumDirections; direction++) {
+    uint64_t line = 0;
+    uint64_t next = Shift(move, direction);
+    while (next & opponent) {
+      line |= next;
+      next = Shift(next, direction);
+    }
+    // Only flip the line if it is closed off by one of our own discs
+    if (next & own) {
+      flips |= line;
+    }
+  }
+  return flips;
+}
+
+Position ApplyMove(const Position& position, int square) {
+  Position next = position;
+  next.is_white_turn = !position.is_white_turn;
+  if (square == kPassMove) {
+    return next;
+  }
+
+  uint64_t& own = position.is_white_turn ? next.white : next.black;
+  uint64_t& opponent = position.is_white_turn ? next.black : next.white;
+  const uint64_t flips = GetFlipMask(own, opponent, square);
+  own |= flips | (1ULL << square);
+  opponent &= ~flips;
+  return next;
+}
+
+bool IsTerminal(const Position& position) {
+  return GetMoveMask(position.black, position.white) == 0
+      && GetMoveMask(position.white, position.black) == 0;
+}
+
+int PickRandomMove(const Position& position, XorShift64& rng) {
+  uint64_t moves = GetMoveMask(position);
+  if (moves == 0) {
+    return kPassMove;
+  }
+  // Picks the k-th legal move by clearing the k lowest bits of the mask
+  uint32_t k = rng.NextBelow(static_cast<uint32_t>(CountDiscs(moves)));
+  for (; k > 0; k--) {
+    moves &= moves - 1;
+  }
+  return LowestSquare(moves);
+}
+
+int RandomPlayout(Position position, XorShift64& rng) {
+  bool last_was_pass = false;
+  for (;;) {
+    const int move = PickRandomMove(position, rng);
+    if (move == kPassMove && last_was_pass) {
+      break; // Neither side can move, so the game is over
+    }
+    last_was_pass = move == kPassMove;
+    position = ApplyMove(position, move);
+  }
+  return CountDiscs(position.black) - CountDiscs(position.white);
+}
+
+}  // namespace logic
@@ -0,0 +1,267 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/features.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace logic {
+
+namespace {
+
+// Directions 0 to 3 and their opposites cover the four axes of the board
+const int kNumAxes = kNumDirections / 2;
+
+const uint64_t kCorners = 0x8100000000000081ULL;
+// The X-squares in the same order as the corners they touch.
+const int kNumCorners = 4;
+const int kCornerSquares[kNumCorners] = {0, 7, 56, 63};
+const int kXSquares[kNumCorners] = {9, 14, 49, 54};
+
+// How many rows are buffered before they are written to the files.
+const size_t kRowsPerFlush = 4096;
+// The .npy header is padded to a fixed size so it can be rewritten in place
+// once the number of rows is known.
+const size_t kNpyHeaderSize = 128;
+const size_t kNpyPreambleSize = 10;
+
+int Opposite(int direction) {
+  return kNumDirections - 1 - direction;
+}
+
+// Squares with no neighbouring square in the given direction.
+uint64_t GetEdge(int direction) {
+  return ~Shift(~0ULL, Opposite(direction));
+}
+
+// Squares whose whole ray in the given direction (not counting the square
+// itself) is occupied, found by growing the rays one step at a time.
+uint64_t GetFullRays(uint64_t occupied, int direction) {
+  const uint64_t edge = GetEdge(direction);
+  uint64_t full = edge;
+  for (int i = 1; i < kBoardSize; i++) {
+    full = edge | Shift(full & occupied, Opposite(direction));
+  }
+  return full;
+}
+
+uint64_t GetFrontier(uint64_t discs, uint64_t empty) {
+  uint64_t next_to_empty = 0;
+  for (int direction = 0; direction < kNumDirections; direction++) {
+    next_to_empty |= Shift(empty, direction);
+  }
+  return discs & next_to_empty;
+}
+
+int CountXSquares(uint64_t discs, uint64_t empty) {
+  int count = 0;
+  for (int i = 0; i < kNumCorners; i++) {
+    if ((empty >> kCornerSquares[i] & 1) && (discs >> kXSquares[i] & 1)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+bool IsLittleEndian() {
+  const uint16_t one = 1;
+  unsigned char first_byte;
+  std::memcpy(&first_byte, &one, 1);
+  return first_byte == 1;
+}
+
+// Writes a version 1.0 .npy header for a float32 array of num_rows rows and
+// num_columns columns, or a one-dimensional array if num_columns is 0.
+void WriteNpyHeader(std::ofstream& file, long long num_rows,
+                    int num_columns) {
+  std::string shape = std::to_string(num_rows) + ",";
+  if (num_columns > 0) {
+    shape += " " + std::to_string(num_columns);
+  }
+  std::string header = std::string("{'descr': '")
+      + (IsLittleEndian() ? "<f4" : ">f4")
+      + "', 'fortran_order': False, 'shape': (" + shape + "), }";
+  header.resize(kNpyHeaderSize - kNpyPreambleSize - 1, ' ');
+  header += '\n';
+
+  const uint16_t header_length = static_cast<uint16_t>(header.size());
+  const char preamble[] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0,
+                           static_cast<char>(header_length & 0xFF),
+                           static_cast<char>(header_length >> 8)};
+  file.seekp(0);
+  file.write(preamble, sizeof(preamble));
+  file.write(header.data(), static_cast<std::streamsize>(header.size()));
+}
+
+}  // namespace
+
+uint64_t GetStableDiscs(const Position& position, bool is_white) {
+  const uint64_t own = is_white ? position.white : position.black;
+  const uint64_t occupied = position.black | position.white;
+
+  // A disc is stable if, along each of the four axes, the line through it is
+  // full, it touches the edge, or it touches a stable disc of its own colour
+  uint64_t protected_by_board = ~0ULL;
+  uint64_t axis_protection[kNumAxes];
+  for (int axis = 0; axis < kNumAxes; axis++) {
+    axis_protection[axis] = (GetFullRays(occupied, axis)
+        & GetFullRays(occupied, Opposite(axis)))
+        | GetEdge(axis) | GetEdge(Opposite(axis));
+    protected_by_board &= axis_protection[axis];
+  }
+
+  uint64_t stable = own & protected_by_board;
+  while (true) {
+    uint64_t next_stable = own;
+    for (int axis = 0; axis < kNumAxes; axis++) {
+      next_stable &= axis_protection[axis] | Shift(stable, axis)
+          | Shift(stable, Opposite(axis));
+    }
+    if (next_stable == stable) {
+      return stable;
+    }
+    stable = next_stable;
+  }
+}
+
+void ExtractFeatures(const Position* positions, size_t num_positions,
+                     float* features) {
+  for (size_t i = 0; i < num_positions; i++) {
+    const Position& position = positions[i];
+    const uint64_t own = position.is_white_turn ? position.white
+                                                : position.black;
+    const uint64_t opponent = position.is_white_turn ? position.black
+                                                     : position.white;
+    const uint64_t empty = ~(own | opponent);
+    float* row = features + i * kNumFeatures;
+
+    row[kOwnDiscs] = static_cast<float>(CountDiscs(own));
+    row[kOpponentDiscs] = static_cast<float>(CountDiscs(opponent));
+    row[kEmptySquares] = static_cast<float>(CountDiscs(empty));
+    row[kOwnMobility] = static_cast<float>(
+        CountDiscs(GetMoveMask(own, opponent)));
+    row[kOpponentMobility] = static_cast<float>(
+        CountDiscs(GetMoveMask(opponent, own)));
+    row[kOwnFrontier] = static_cast<float>(
+        CountDiscs(GetFrontier(own, empty)));
+    row[kOpponentFrontier] = static_cast<float>(
+        CountDiscs(GetFrontier(opponent, empty)));
+    row[kOwnCorners] = static_cast<float>(CountDiscs(own & kCorners));
+    row[kOpponentCorners] = static_cast<float>(
+        CountDiscs(opponent & kCorners));
+    row[kOwnXSquares] = static_cast<float>(CountXSquares(own, empty));
+    row[kOpponentXSquares] = static_cast<float>(
+        CountXSquares(opponent, empty));
+    row[kOwnStable] = static_cast<float>(
+        CountDiscs(GetStableDiscs(position, position.is_white_turn)));
+    row[kOpponentStable] = static_cast<float>(
+        CountDiscs(GetStableDiscs(position, !position.is_white_turn)));
+    row[kParity] = static_cast<float>(CountDiscs(empty) % 2);
+  }
+}
+
+FeatureVector ExtractFeatures(const Position& position) {
+  FeatureVector features;
+  ExtractFeatures(&position, 1, features.data());
+  return features;
+}
+
+FeatureExporter::FeatureExporter(const std::string& features_path,
+                                 const std::string& labels_path)
+    : features_file_{features_path, std::ios::binary | std::ios::trunc},
+      labels_file_{labels_path, std::ios::binary | std::ios::trunc} {
+  if (!features_file_ || !labels_file_) {
+    throw std::runtime_error("Could not open the feature export files");
+  }
+  pending_positions_.reserve(kRowsPerFlush);
+  pending_labels_.reserve(kRowsPerFlush);
+  feature_rows_.resize(kRowsPerFlush * kNumFeatures);
+
+  // Placeholder headers; Finish rewrites them with the real row count
+  WriteNpyHeader(features_file_, 0, kNumFeatures);
+  WriteNpyHeader(labels_file_, 0, 0);
+}
+
+FeatureExporter::~FeatureExporter() {
+  if (!is_finished_) {
+    try {
+      Finish();
+    } catch (const std::runtime_error&) {
+      // A destructor must not throw; call Finish directly to see the error
+    }
+  }
+}
+
+void FeatureExporter::Add(const Position& position, float label) {
+  if (is_finished_) {
+    throw std::runtime_error("Rows cannot be added after Finish");
+  }
+  pending_positions_.push_back(position);
+  pending_labels_.push_back(label);
+  num_rows_++;
+  if (pending_positions_.size() == kRowsPerFlush) {
+    Flush();
+  }
+}
+
+void FeatureExporter::Finish() {
+  if (is_finished_) {
+    return;
+  }
+  is_finished_ = true;
+  Flush();
+  WriteNpyHeader(features_file_, num_rows_, kNumFeatures);
+  WriteNpyHeader(labels_file_, num_rows_, 0);
+  features_file_.close();
+  labels_file_.close();
+  if (!features_file_ || !labels_file_) {
+    throw std::runtime_error("Could not write the feature export files");
+  }
+}
+
+long long FeatureExporter::GetNumRows() const {
+  return num_rows_;
+}
+
+void FeatureExporter::Flush() {
+  const size_t num_pending = pending_positions_.size();
+  ExtractFeatures(pending_positions_.data(), num_pending,
+                  feature_rows_.data());
+  features_file_.write(reinterpret_cast<const char*>(feature_rows_.data()),
+      static_cast<std::streamsize>(num_pending * kNumFeatures
+                                   * sizeof(float)));
+  labels_file_.write(reinterpret_cast<const char*>(pending_labels_.data()),
+      static_cast<std::streamsize>(num_pending * sizeof(float)));
+  pending_positions_.clear();
+  pending_labels_.clear();
+}
+
+long long ExportRandomGames(const std::string& features_path,
+                            const std::string& labels_path,
+                            long long num_games, uint64_t seed) {
+  FeatureExporter exporter(features_path, labels_path);
+  XorShift64 rng(seed);
+  // Only one game is held in memory at a time; a game has at most 60 moves
+  // plus a pass by each side after every move
+  vector<Position> game;
+  game.reserve(2 * kNumSquares);
+
+  for (long long i = 0; i < num_games; i++) {
+    game.clear();
+    Position position = InitialPosition();
+    while (!IsTerminal(position)) {
+      game.push_back(position);
+      position = ApplyMove(position, PickRandomMove(position, rng));
+    }
+    const int black_differential = CountDiscs(position.black)
+        - CountDiscs(position.white);
+    for (const Position& seen : game) {
+      exporter.Add(seen, static_cast<float>(
+          seen.is_white_turn ? -black_differential : black_differential));
+    }
+  }
+  exporter.Finish();
+  return exporter.GetNumRows();
+}
+
+}  // namespace logic
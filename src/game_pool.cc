@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/game_pool.h"
+
+#include <stdexcept>
+
+namespace othello {
+
+namespace {
+
+const int kSlotBits = 20;
+const uint32_t kSlotMask = (1u << kSlotBits) - 1;
+const uint32_t kGenerationMask = (1u << (32 - kSlotBits)) - 1;
+
+}  // namespace
+
+const uint32_t GamePool::kMaxCapacity;
+const uint32_t GamePool::kNoGame;
+
+GamePool::GamePool(uint32_t capacity)
+    : capacity_{capacity}, first_free_{kNoGame} {
+  if (capacity > kMaxCapacity) {
+    throw std::runtime_error("A game pool can hold at most 2^20 - 1 games");
+  }
+  slots_.reset(new Slot[capacity]);
+  // Chains every slot into the free list, lowest slot first
+  for (uint32_t slot = capacity; slot > 0; slot--) {
+    slots_[slot - 1].next_free = first_free_;
+    first_free_ = slot - 1;
+  }
+}
+
+uint32_t GamePool::Create(int owner) {
+  if (first_free_ == kNoGame || owner < 0) {
+    return kNoGame;
+  }
+  const uint32_t index = first_free_;
+  Slot& slot = slots_[index];
+  first_free_ = slot.next_free;
+  slot.position = logic::InitialPosition();
+  slot.owner = owner;
+
+  // Puts the game at the front of its owner's list
+  const size_t owner_index = static_cast<size_t>(owner);
+  if (owner_index >= first_owned_.size()) {
+    first_owned_.resize(owner_index + 1, kNoGame);
+  }
+  slot.previous_owned = kNoGame;
+  slot.next_owned = first_owned_[owner_index];
+  if (slot.next_owned != kNoGame) {
+    slots_[slot.next_owned].previous_owned = index;
+  }
+  first_owned_[owner_index] = index;
+  num_games_++;
+  return slot.generation << kSlotBits | index;
+}
+
+logic::Position* GamePool::Find(uint32_t game_id, int owner) {
+  Slot* slot = FindSlot(game_id);
+  return slot != nullptr && slot->owner == owner ? &slot->position : nullptr;
+}
+
+void GamePool::Release(uint32_t game_id) {
+  Slot* slot = FindSlot(game_id);
+  if (slot == nullptr) {
+    return;
+  }
+  const uint32_t index = game_id & kSlotMask;
+  // Takes the game out of its owner's list
+  if (slot->previous_owned != kNoGame) {
+    slots_[slot->previous_owned].next_owned = slot->next_owned;
+  } else {
+    first_owned_[static_cast<size_t>(slot->owner)] = slot->next_owned;
+  }
+  if (slot->next_owned != kNoGame) {
+    slots_[slot->next_owned].previous_owned = slot->previous_owned;
+  }
+  slot->owner = -1;
+  slot->generation = (slot->generation + 1) & kGenerationMask;
+  slot->next_free = first_free_;
+  first_free_ = index;
+  num_games_--;
+}
+
+void GamePool::ReleaseAll(int owner) {
+  if (owner < 0 || static_cast<size_t>(owner) >= first_owned_.size()) {
+    return; // This owner never had a game
+  }
+  // Each release moves the next game of the owner to the front of its list
+  uint32_t& first = first_owned_[static_cast<size_t>(owner)];
+  while (first != kNoGame) {
+    Release(slots_[first].generation << kSlotBits | first);
+  }
+}
+
+uint32_t GamePool::GetNumGames() const {
+  return num_games_;
+}
+
+uint32_t GamePool::GetCapacity() const {
+  return capacity_;
+}
+
+GamePool::Slot* GamePool::FindSlot(uint32_t game_id) {
+  const uint32_t index = game_id & kSlotMask;
+  if (index >= capacity_ || slots_[index].owner == -1) {
+    return nullptr;
+  }
+  Slot& slot = slots_[index];
+  return (game_id >> kSlotBits) == slot.generation ? &slot : nullptr;
+}
+
+}  // namespace othello
@@ -0,0 +1,192 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/game_session.h"
+
+namespace logic {
+
+GameSession::GameSession() {
+  Reset();
+}
+
+void GameSession::Reset() {
+  SetPosition(InitialPosition());
+}
+
+void GameSession::SetPosition(const Position& position) {
+  start_position_ = position;
+  game_board_ = ToGameBoard(position);
+  potential_game_board_.assign(kBoardSize, vector<string>(kBoardSize, ""));
+  is_white_turn_ = position.is_white_turn;
+  history_.Clear();
+  is_result_reported_ = false;
+  RefreshAfterHistoryChange();
+}
+
+ClickResult GameSession::Click(int x_tile_coordinate_,
+                               int y_tile_coordinate_) {
+  ClickResult result;
+  // If the user did not select a valid move, it is still their turn. This
+  // prevents users from playing impossible moves in the game.
+  if (!IsMoveValid(x_tile_coordinate_, y_tile_coordinate_, is_white_turn_,
+                   game_board_)) {
+    return result;
+  }
+  result.is_move_played = true;
+  const Position before_move = ToPosition(game_board_, is_white_turn_);
+  game_board_[x_tile_coordinate_][y_tile_coordinate_] =
+      is_white_turn_ ? "white" : "black";
+
+  // Flips the pieces on the game board based on the move the user played
+  const int num_flipped = FlipPiecesInPlace(x_tile_coordinate_,
+      y_tile_coordinate_, is_white_turn_, game_board_);
+  UpdateScores(num_flipped);
+
+  is_white_turn_ = !is_white_turn_; // Changes whose turn it is
+  valid_moves_ = logic::GetValidMoves(game_board_, is_white_turn_);
+  if (valid_moves_.empty()) {
+    // If there are no valid moves, it's the other player's turn again
+    is_white_turn_ = !is_white_turn_;
+    valid_moves_ = logic::GetValidMoves(game_board_, is_white_turn_);
+  }
+
+  // Recorded only now because a forced pass changes whose turn it is next
+  history_.Record(before_move,
+      x_tile_coordinate_ * kBoardSize + y_tile_coordinate_, is_white_turn_);
+
+  // The game can end before the board is full, when neither player has a
+  // move left. It is only checked after a move so that clicking on a
+  // finished game does not end it again.
+  is_game_over_ = logic::IsGameOver(game_board_);
+  result.is_game_over = is_game_over_ && !is_result_reported_;
+  is_result_reported_ = is_result_reported_ || is_game_over_;
+  return result;
+}
+
+void GameSession::Hover(int x_tile_coordinate_, int y_tile_coordinate_) {
+  // If the user hovers over a valid move, then the appropriate pieces in
+  // potential game board will be filled to show what the game board would
+  // look like if they moved there.
+  if (!IsMoveValid(x_tile_coordinate_, y_tile_coordinate_, is_white_turn_,
+                   game_board_)) {
+    ClearPotentialGameBoard();
+    return;
+  }
+  // Assigning reuses the storage of the potential game board, so hovering
+  // does not allocate
+  potential_game_board_ = game_board_;
+  FlipPiecesInPlace(x_tile_coordinate_, y_tile_coordinate_, is_white_turn_,
+                    potential_game_board_);
+  potential_game_board_[x_tile_coordinate_][y_tile_coordinate_] =
+      is_white_turn_ ? "white" : "black";
+}
+
+bool GameSession::Undo() {
+  if (!history_.Undo(game_board_, is_white_turn_)) {
+    return false;
+  }
+  RefreshAfterHistoryChange();
+  return true;
+}
+
+bool GameSession::Redo() {
+  if (!history_.Redo(game_board_, is_white_turn_)) {
+    return false;
+  }
+  RefreshAfterHistoryChange();
+  return true;
+}
+
+void GameSession::JumpToPly(size_t ply) {
+  history_.JumpToPly(ply, game_board_, is_white_turn_);
+  RefreshAfterHistoryChange();
+}
+
+const vector<vector<string>>& GameSession::GetGameBoard() const {
+  return game_board_;
+}
+
+const vector<vector<string>>& GameSession::GetPotentialGameBoard() const {
+  return potential_game_board_;
+}
+
+const vector<pair<int, int>>& GameSession::GetValidMoves() const {
+  return valid_moves_;
+}
+
+const MoveHistory& GameSession::GetHistory() const {
+  return history_;
+}
+
+const Position& GameSession::GetStartPosition() const {
+  return start_position_;
+}
+
+bool GameSession::IsWhiteTurn() const {
+  return is_white_turn_;
+}
+
+int GameSession::GetBlackScore() const {
+  return black_score_;
+}
+
+int GameSession::GetWhiteScore() const {
+  return white_score_;
+}
+
+bool GameSession::IsGameOver() const {
+  return is_game_over_;
+}
+
+string GameSession::GetWinner() const {
+  if (white_score_ > black_score_) {
+    return "white";
+  } else if (white_score_ < black_score_) {
+    return "black";
+  }
+  return "tie";
+}
+
+void GameSession::UpdateScores(int num_flipped) {
+  // The player who moved gains the placed piece and every flipped piece,
+  // and the other player loses the flipped pieces.
+  if (is_white_turn_) {
+    white_score_ += num_flipped + 1;
+    black_score_ -= num_flipped;
+  } else {
+    black_score_ += num_flipped + 1;
+    white_score_ -= num_flipped;
+  }
+}
+
+void GameSession::CountScores() {
+  white_score_ = 0;
+  black_score_ = 0;
+  for (const auto& row : game_board_) {
+    for (const auto& tile : row) {
+      if (tile == "white") {
+        white_score_++;
+      } else if (tile == "black") {
+        black_score_++;
+      }
+    }
+  }
+}
+
+void GameSession::RefreshAfterHistoryChange() {
+  valid_moves_ = logic::GetValidMoves(game_board_, is_white_turn_);
+  // Jumps can cross many moves, so the scores are counted from the board
+  CountScores();
+  is_game_over_ = logic::IsGameOver(game_board_);
+  // The hover-over board belongs to the old ply, so it is cleared
+  ClearPotentialGameBoard();
+}
+
+void GameSession::ClearPotentialGameBoard() {
+  for (auto& row : potential_game_board_) {
+    for (auto& tile : row) {
+      tile = "";
+    }
+  }
+}
+
+}  // namespace logic
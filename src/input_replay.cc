@@ -0,0 +1,207 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/input_replay.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace logic {
+
+namespace {
+
+const char kRecordingMagic[] = "othello-input-recording";
+const int kRecordingVersion = 2;
+
+// The name of each InputEventType in a recording file, in enum order.
+const int kNumEventTypes = 7;
+const char* const kEventNames[kNumEventTypes] = {
+    "down", "move", "reset", "undo", "redo", "start", "end"};
+
+using Clock = std::chrono::steady_clock;
+
+// Summarises a list of latencies, sorting it in the process. Percentiles use
+// the nearest-rank method.
+LatencyStats Summarize(std::vector<double>& latencies) {
+  LatencyStats stats;
+  stats.count = latencies.size();
+  if (latencies.empty()) {
+    return stats;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  double total = 0;
+  for (double latency : latencies) {
+    total += latency;
+  }
+  auto percentile = [&latencies](double fraction) {
+    const size_t rank = static_cast<size_t>(
+        fraction * static_cast<double>(latencies.size() - 1) + 0.5);
+    return latencies[rank];
+  };
+  stats.mean_us = total / static_cast<double>(latencies.size());
+  stats.p50_us = percentile(0.5);
+  stats.p90_us = percentile(0.9);
+  stats.p99_us = percentile(0.99);
+  stats.max_us = latencies.back();
+  return stats;
+}
+
+}  // namespace
+
+InputRecorder::InputRecorder(const std::string& path,
+                             const GameSession& session, int tile_length)
+    : file_{path, std::ios::trunc}, start_time_{Clock::now()} {
+  if (!file_) {
+    throw std::runtime_error("Could not open the input recording " + path);
+  }
+  const Position& start = session.GetStartPosition();
+  const MoveHistory& history = session.GetHistory();
+  file_ << kRecordingMagic << ' ' << kRecordingVersion << '\n'
+        << tile_length << ' ' << start.black << ' ' << start.white << ' '
+        << start.is_white_turn << '\n'
+        << history.GetNumPlies() << ' ' << history.GetPly();
+  for (size_t ply = 0; ply < history.GetNumPlies(); ply++) {
+    file_ << ' ' << history.GetSquare(ply);
+  }
+  file_ << '\n';
+}
+
+void InputRecorder::Record(InputEventType type, int x, int y) {
+  const long long time_us = std::chrono::duration_cast<
+      std::chrono::microseconds>(Clock::now() - start_time_).count();
+  file_ << time_us << ' ' << kEventNames[static_cast<int>(type)] << ' ' << x
+        << ' ' << y << '\n';
+  num_events_++;
+}
+
+size_t InputRecorder::GetNumEvents() const {
+  return num_events_;
+}
+
+InputRecording ReadInputRecording(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Could not open the input recording " + path);
+  }
+  InputRecording recording;
+  std::string magic;
+  int version = 0;
+  file >> magic >> version >> recording.tile_length >> recording.start.black
+      >> recording.start.white >> recording.start.is_white_turn;
+  size_t num_moves = 0;
+  file >> num_moves >> recording.ply;
+  if (!file || magic != kRecordingMagic || version != kRecordingVersion
+      || recording.tile_length <= 0 || num_moves > kNumSquares
+      || recording.ply > num_moves) {
+    throw std::runtime_error(path + " is not an input recording");
+  }
+  recording.history.resize(num_moves);
+  for (int& square : recording.history) {
+    if (!(file >> square) || square < 0 || square >= kNumSquares) {
+      throw std::runtime_error(path + " is not an input recording");
+    }
+  }
+
+  InputEvent event;
+  std::string name;
+  while (file >> event.time_us >> name >> event.x >> event.y) {
+    const auto found = std::find(kEventNames, kEventNames + kNumEventTypes,
+                                 name);
+    if (found == kEventNames + kNumEventTypes) {
+      throw std::runtime_error("Unknown input event " + name + " in " + path);
+    }
+    event.type = static_cast<InputEventType>(found - kEventNames);
+    recording.events.push_back(event);
+  }
+  if (!file.eof()) {
+    throw std::runtime_error("Malformed input event in " + path);
+  }
+  return recording;
+}
+
+void RestoreRecordedGame(GameSession& session,
+                         const InputRecording& recording) {
+  // Playing the moves again rebuilds the same history, forced passes and
+  // all, which undo and redo events may then step through
+  session.SetPosition(recording.start);
+  for (int square : recording.history) {
+    if (!session.Click(square / kBoardSize, square % kBoardSize)
+        .is_move_played) {
+      throw std::runtime_error("The recorded game has an illegal move");
+    }
+  }
+  session.JumpToPly(recording.ply);
+}
+
+bool ApplyInputEvent(GameSession& session, const InputEvent& event,
+                     int tile_length) {
+  switch (event.type) {
+    case InputEventType::kMouseDown:
+      return session.Click(event.x / tile_length,
+                           event.y / tile_length).is_move_played;
+    case InputEventType::kMouseMove:
+      session.Hover(event.x / tile_length, event.y / tile_length);
+      break;
+    case InputEventType::kReset:
+      session.Reset();
+      break;
+    case InputEventType::kUndo:
+      session.Undo();
+      break;
+    case InputEventType::kRedo:
+      session.Redo();
+      break;
+    case InputEventType::kJumpToStart:
+      session.JumpToPly(0);
+      break;
+    case InputEventType::kJumpToEnd:
+      session.JumpToPly(session.GetHistory().GetNumPlies());
+      break;
+  }
+  return false;
+}
+
+ReplayReport ReplayInput(const InputRecording& recording, int repetitions) {
+  std::vector<double> clicks;
+  std::vector<double> hovers;
+  std::vector<double> others;
+  const size_t num_events = recording.events.size()
+      * static_cast<size_t>(std::max(repetitions, 0));
+  // Reserved up front so that recording a latency never allocates
+  clicks.reserve(num_events);
+  hovers.reserve(num_events);
+  others.reserve(num_events);
+
+  ReplayReport report;
+  GameSession session;
+  const Clock::time_point replay_start = Clock::now();
+  for (int i = 0; i < repetitions; i++) {
+    RestoreRecordedGame(session, recording);
+    for (const InputEvent& event : recording.events) {
+      const Clock::time_point start = Clock::now();
+      const bool is_move_played = ApplyInputEvent(session, event,
+                                                  recording.tile_length);
+      const double latency_us = std::chrono::duration<double, std::micro>(
+          Clock::now() - start).count();
+
+      if (event.type == InputEventType::kMouseDown) {
+        clicks.push_back(latency_us);
+        if (is_move_played) {
+          report.moves_played++;
+        }
+      } else if (event.type == InputEventType::kMouseMove) {
+        hovers.push_back(latency_us);
+      } else {
+        others.push_back(latency_us);
+      }
+    }
+  }
+  report.seconds = std::chrono::duration<double>(
+      Clock::now() - replay_start).count();
+  report.clicks = Summarize(clicks);
+  report.hovers = Summarize(hovers);
+  report.others = Summarize(others);
+  return report;
+}
+
+}  // namespace logic
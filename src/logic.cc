@@ -6,107 +6,152 @@
 
 namespace logic {
 
-vector<vector<string>> FlipPieces(int& x_tile_coordinate_,
-    int& y_tile_coordinate_, bool is_white_turn_,
-    vector<vector<string>> game_board_) {
-  string last_turn_color = "black";
-  if (is_white_turn_) {
-    last_turn_color = "white";
+namespace {
+
+const char kWhite[] = "white";
+const char kBlack[] = "black";
+
+// The colour names are compared as C strings so that checking a move never
+// builds a std::string.
+const char* GetColor(bool is_white_turn_) {
+  return is_white_turn_ ? kWhite : kBlack;
+}
+
+bool IsMoveValidForColor(int x_tile_coordinate_, int y_tile_coordinate_,
+                         const char* last_turn_color,
+                         const vector<vector<string>>& game_board_) {
+  if (!InBounds(x_tile_coordinate_, y_tile_coordinate_)) {
+    return false;
+  }
+  // If there's already a piece at that spot on the board, it is not
+  // possible for it to be a valid move.
+  if (!game_board_[x_tile_coordinate_][y_tile_coordinate_].empty()) {
+    return false;
   }
-  // Vector that will store coordinates of pieces that should be flipped
-  vector<pair<int, int>> to_flip;
 
-  // This for loop loops through each of the 8 directions that are
-  // adjacent to the user's move, and gets the pieces that should be flipped
   for (size_t i = 0; i < kXChange.size(); i++) {
+    bool is_opposite_color_adjacent = false;
     int x = x_tile_coordinate_;
     int y = y_tile_coordinate_;
 
     for (size_t j = 0; j < kBoardSize; j++) {
-      x += kXChange[i]; // Increments x and y here to change direction
+      x += kXChange[i];
       y += kYChange[i];
-      if (!InBounds(x, y)) { // If the move isn't in bounds, there's no flipping
+      if (!InBounds(x, y)) {
         break;
       }
 
+      // If the coordinate has pieces that are adjacent and have pieces
+      // of the same color that lead to flips, it's a valid move
       if (game_board_[x][y].empty()) {
-        break; // If the coordinate has no piece, it will not be flipped
+        break;
       } else if (game_board_[x][y] != last_turn_color) {
-        to_flip.emplace_back(x, y); // Adds the pair of coordinates to to_flip
+        is_opposite_color_adjacent = true;
+      } else if (is_opposite_color_adjacent) {
+        return true;
       } else {
-        // Once a coordinate of the same color is reached, then and only then
-        // should pieces be flipped.
-        for (const auto& pair : to_flip) {
-          game_board_[pair.first][pair.second] = last_turn_color;
-        }
         break;
       }
     }
-    to_flip.clear(); // Clear to_flip to do the same thing in another direction
   }
 
-  return game_board_;
+  return false;
 }
 
-bool InBounds(int x, int y) {
-  return (x >= 0) && (x < kBoardSize) && (y >= 0) && (y < kBoardSize);
+}  // namespace
+
+vector<vector<string>> FlipPieces(int& x_tile_coordinate_,
+    int& y_tile_coordinate_, bool is_white_turn_,
+    vector<vector<string>> game_board_) {
+  FlipPiecesInPlace(x_tile_coordinate_, y_tile_coordinate_, is_white_turn_,
+                    game_board_);
+  return game_board_;
 }
 
-bool IsMoveValid(int& x_tile_coordinate_, int& y_tile_coordinate_,
-                 bool is_white_turn_, vector<vector<string>>& game_board_) {
-  if (!InBounds(x_tile_coordinate_, y_tile_coordinate_)) {
-    return false;
-  }
-  string last_turn_color = "black";
-  if (is_white_turn_) {
-    last_turn_color = "white";
-  }
-  // If there's already a piece at that spot on the board, it is not
-  // possible for it to be a valid move.
-  if (!game_board_[x_tile_coordinate_][y_tile_coordinate_].empty()) {
-    return false;
-  }
+int FlipPiecesInPlace(int x_tile_coordinate_, int y_tile_coordinate_,
+                      bool is_white_turn_,
+                      vector<vector<string>>& game_board_) {
+  const char* last_turn_color = GetColor(is_white_turn_);
+  int num_flipped = 0;
+  // Coordinates of pieces that should be flipped in the current direction.
+  // A line never has more than kBoardSize pieces, so no vector is needed.
+  pair<int, int> to_flip[kBoardSize];
 
+  // This for loop loops through each of the 8 directions that are
+  // adjacent to the user's move, and gets the pieces that should be flipped
   for (size_t i = 0; i < kXChange.size(); i++) {
-    bool is_opposite_color_adjacent = false;
     int x = x_tile_coordinate_;
     int y = y_tile_coordinate_;
+    int num_to_flip = 0;
 
     for (size_t j = 0; j < kBoardSize; j++) {
-      x += kXChange[i];
+      x += kXChange[i]; // Increments x and y here to change direction
       y += kYChange[i];
-      if (!InBounds(x, y)) {
+      if (!InBounds(x, y)) { // If the move isn't in bounds, there's no flipping
         break;
       }
 
-      // If the coordinate has pieces that are adjacent and have pieces
-      // of the same color that lead to flips, it's a valid move
       if (game_board_[x][y].empty()) {
-        break;
+        break; // If the coordinate has no piece, it will not be flipped
       } else if (game_board_[x][y] != last_turn_color) {
-        is_opposite_color_adjacent = true;
-      } else if (is_opposite_color_adjacent) {
-        return true;
+        to_flip[num_to_flip++] = {x, y}; // Adds the pair to to_flip
       } else {
+        // Once a coordinate of the same color is reached, then and only then
+        // should pieces be flipped.
+        for (int k = 0; k < num_to_flip; k++) {
+          game_board_[to_flip[k].first][to_flip[k].second] = last_turn_color;
+        }
+        num_flipped += num_to_flip;
         break;
       }
     }
   }
 
-  return false;
+  return num_flipped;
+}
+
+bool InBounds(int x, int y) {
+  return (x >= 0) && (x < kBoardSize) && (y >= 0) && (y < kBoardSize);
+}
+
+bool IsMoveValid(int& x_tile_coordinate_, int& y_tile_coordinate_,
+                 bool is_white_turn_, vector<vector<string>>& game_board_) {
+  return IsMoveValidForColor(x_tile_coordinate_, y_tile_coordinate_,
+                             GetColor(is_white_turn_), game_board_);
 }
 
 vector<pair<int, int>> GetValidMoves(vector<vector<string>>& game_board_,
     bool is_white_turn_) {
-  vector<pair<int, int>> moves; // The vector of valid moves
+  MoveBuffer buffer;
+  const size_t num_moves = GetValidMoves(game_board_, is_white_turn_, buffer);
+  return vector<pair<int, int>>(buffer.begin(), buffer.begin() + num_moves);
+}
+
+size_t GetValidMoves(const vector<vector<string>>& game_board_,
+                     bool is_white_turn_, MoveBuffer& moves) {
+  const char* last_turn_color = GetColor(is_white_turn_);
+  size_t num_moves = 0;
   // This loops through the entire board and finds coordinates that are
   // empty and are valid moves
-  for (size_t i = 0; i < kBoardSize; i++) {
-    for (size_t j = 0; j < kBoardSize; j++) {
-      if (game_board_[i][j].empty() && IsMoveValid
-      (reinterpret_cast<int&>(i), reinterpret_cast<int&>(j),
-          is_white_turn_, game_board_)) {
-        moves.emplace_back(i, j);
+  for (int i = 0; i < kBoardSize; i++) {
+    for (int j = 0; j < kBoardSize; j++) {
+      if (IsMoveValidForColor(i, j, last_turn_color, game_board_)) {
+        moves[num_moves++] = {i, j};
+      }
+    }
+  }
+
+  return num_moves;
+}
+
+uint64_t GetValidMoveMask(const vector<vector<string>>& game_board_,
+                          bool is_white_turn_) {
+  const char* last_turn_color = GetColor(is_white_turn_);
+  uint64_t moves = 0;
+  for (int i = 0; i < kBoardSize; i++) {
+    for (int j = 0; j < kBoardSize; j++) {
+      if (IsMoveValidForColor(i, j, last_turn_color, game_board_)) {
+        moves |= 1ULL << (i * kBoardSize + j);
       }
     }
   }
@@ -114,4 +159,9 @@ vector<pair<int, int>> GetValidMoves(vector<vector<string>>& game_board_,
   return moves;
 }
 
-}
\ No newline at end of file
+bool IsGameOver(const vector<vector<string>>& game_board_) {
+  return GetValidMoveMask(game_board_, false) == 0
+      && GetValidMoveMask(game_board_, true) == 0;
+}
+
+}
@@ -0,0 +1,310 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/match_load.h"
+
+#include <stdexcept>
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mylibrary/bitboard.h"
+#include "mylibrary/match_protocol.h"
+
+namespace othello {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Each connection keeps at most this many latencies, picked by reservoir
+// sampling, so memory does not grow with the length of the test
+const size_t kMaxLatencySamples = 1 << 18;
+
+void ThrowSystemError(const std::string& what) {
+  throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+int Connect(const LoadTestOptions& options) {
+  int fd;
+  int result;
+  if (!options.unix_path.empty()) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (options.unix_path.size() >= sizeof(address.sun_path)) {
+      throw std::runtime_error("The Unix socket path is too long");
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, options.unix_path.c_str(),
+                options.unix_path.size() + 1);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    result = fd < 0 ? -1 : connect(fd, reinterpret_cast<sockaddr*>(&address),
+                                   sizeof(address));
+  } else {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+      throw std::runtime_error("Not an IPv4 address: " + options.host);
+    }
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    result = fd < 0 ? -1 : connect(fd, reinterpret_cast<sockaddr*>(&address),
+                                   sizeof(address));
+    const int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  }
+  if (result < 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    ThrowSystemError("Could not connect to the match server");
+  }
+  return fd;
+}
+
+void SendAll(int fd, const std::vector<uint8_t>& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    const ssize_t num_sent = send(fd, data.data() + sent, data.size() - sent,
+                                  MSG_NOSIGNAL);
+    if (num_sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ThrowSystemError("Sending to the match server failed");
+    }
+    sent += static_cast<size_t>(num_sent);
+  }
+}
+
+// The state of one connection of the load test.
+class LoadClient {
+ public:
+  LoadClient(const LoadTestOptions& options, uint64_t seed)
+      : fd_{Connect(options)}, rng_{seed},
+        game_ids_(static_cast<size_t>(options.games_per_connection)),
+        positions_(game_ids_.size()),
+        input_(game_ids_.size() * kGameUpdateSize) {
+    latencies_.reserve(std::min(kMaxLatencySamples, game_ids_.size() * 64));
+  }
+
+  ~LoadClient() {
+    close(fd_);
+  }
+
+  void Run(Clock::time_point deadline) {
+    // Starts every game, then sends one move per game at a time until the
+    // time is up. Games that end are replaced before the next round.
+    std::vector<size_t> new_games(game_ids_.size());
+    for (size_t i = 0; i < new_games.size(); i++) {
+      new_games[i] = i;
+    }
+    while (true) {
+      if (!new_games.empty()) {
+        CreateGames(new_games);
+        new_games.clear();
+      }
+      if (Clock::now() >= deadline) {
+        return;
+      }
+      PlayRound(new_games);
+    }
+  }
+
+  long long GetMoves() const {
+    return moves_;
+  }
+
+  long long GetGamesFinished() const {
+    return games_finished_;
+  }
+
+  const std::vector<double>& GetLatencies() const {
+    return latencies_;
+  }
+
+ private:
+  void CreateGames(const std::vector<size_t>& slots) {
+    output_.clear();
+    MatchRequest request;
+    request.type = kCreateGame;
+    for (size_t slot : slots) {
+      request.tag = static_cast<uint32_t>(slot);
+      AppendRequest(request);
+    }
+    SendAll(fd_, output_);
+    ReceiveUpdates(slots.size(), [this](const GameUpdate& update) {
+      game_ids_[update.tag] = update.game_id;
+      positions_[update.tag] = update.position;
+    });
+  }
+
+  void PlayRound(std::vector<size_t>& finished_games) {
+    output_.clear();
+    MatchRequest request;
+    request.type = kPlayMove;
+    for (size_t slot = 0; slot < game_ids_.size(); slot++) {
+      request.tag = static_cast<uint32_t>(slot);
+      request.game_id = game_ids_[slot];
+      request.square = static_cast<uint8_t>(
+          logic::PickRandomMove(positions_[slot], rng_));
+      AppendRequest(request);
+    }
+    const Clock::time_point sent = Clock::now();
+    SendAll(fd_, output_);
+    ReceiveUpdates(game_ids_.size(), [&](const GameUpdate& update) {
+      RecordLatency(std::chrono::duration<double, std::micro>(
+          Clock::now() - sent).count());
+      moves_++;
+      positions_[update.tag] = update.position;
+      if (update.is_game_over) {
+        games_finished_++;
+        finished_games.push_back(update.tag);
+      }
+    });
+  }
+
+  void AppendRequest(const MatchRequest& request) {
+    const size_t end = output_.size();
+    output_.resize(end + kMaxMessageSize);
+    output_.resize(end + EncodeRequest(request, output_.data() + end));
+  }
+
+  // Reads exactly count game updates, passing each to handle as soon as it
+  // has arrived.
+  template <typename Handler>
+  void ReceiveUpdates(size_t count, Handler handle) {
+    size_t received = 0;
+    size_t decoded = 0;
+    while (decoded < count) {
+      const ssize_t num_read = recv(fd_, input_.data() + received,
+                                    count * kGameUpdateSize - received, 0);
+      if (num_read <= 0) {
+        if (num_read < 0 && errno == EINTR) {
+          continue;
+        }
+        ThrowSystemError("The match server closed the connection");
+      }
+      received += static_cast<size_t>(num_read);
+      GameUpdate update;
+      while (DecodeGameUpdate(input_.data() + decoded * kGameUpdateSize,
+                              received - decoded * kGameUpdateSize, update)
+             > 0) {
+        if (update.status != kOk) {
+          throw std::runtime_error("The match server rejected a request");
+        }
+        handle(update);
+        decoded++;
+      }
+    }
+  }
+
+  void RecordLatency(double latency_us) {
+    num_latencies_++;
+    if (latencies_.size() < kMaxLatencySamples) {
+      latencies_.push_back(latency_us);
+      return;
+    }
+    const uint64_t index = rng_.Next() % num_latencies_;
+    if (index < kMaxLatencySamples) {
+      latencies_[static_cast<size_t>(index)] = latency_us;
+    }
+  }
+
+  int fd_;
+  logic::XorShift64 rng_;
+  std::vector<uint32_t> game_ids_;
+  std::vector<logic::Position> positions_;
+  std::vector<uint8_t> output_;
+  std::vector<uint8_t> input_;
+  std::vector<double> latencies_;
+  uint64_t num_latencies_ = 0;
+  long long moves_ = 0;
+  long long games_finished_ = 0;
+};
+
+}  // namespace
+
+LoadTestReport RunLoadTest(const LoadTestOptions& options) {
+  if (options.connections <= 0 || options.games_per_connection <= 0) {
+    throw std::runtime_error("A load test needs connections and games");
+  }
+  std::vector<std::unique_ptr<LoadClient>> clients;
+  for (int i = 0; i < options.connections; i++) {
+    clients.emplace_back(new LoadClient(options,
+        options.seed + static_cast<uint64_t>(i)));
+  }
+
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  const Clock::time_point start = Clock::now();
+  const Clock::time_point deadline = start + options.duration;
+  std::vector<std::thread> threads;
+  for (auto& client : clients) {
+    LoadClient* load_client = client.get();
+    threads.emplace_back([load_client, deadline, &error_mutex, &error]() {
+      try {
+        load_client->Run(deadline);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        error = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  LoadTestReport report;
+  report.seconds = std::chrono::duration<double>(Clock::now() - start)
+      .count();
+  std::vector<double> latencies;
+  for (const auto& client : clients) {
+    report.moves += client->GetMoves();
+    report.games_finished += client->GetGamesFinished();
+    latencies.insert(latencies.end(), client->GetLatencies().begin(),
+                     client->GetLatencies().end());
+  }
+  report.moves_per_second = static_cast<double>(report.moves)
+      / report.seconds;
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    const double last = static_cast<double>(latencies.size() - 1);
+    report.p50_latency_us = latencies[static_cast<size_t>(last * 0.5)];
+    report.p99_latency_us = latencies[static_cast<size_t>(last * 0.99)];
+    report.max_latency_us = latencies.back();
+  }
+  return report;
+}
+
+}  // namespace othello
+
+#else
+
+namespace othello {
+
+LoadTestReport RunLoadTest(const LoadTestOptions&) {
+  throw std::runtime_error("The load test client is Linux only");
+}
+
+}  // namespace othello
+
+#endif  // __linux__
@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/match_protocol.h"
+
+#include <stdexcept>
+
+namespace othello {
+
+namespace {
+
+// The bits of the GameUpdate flags byte
+const uint8_t kWhiteTurnFlag = 1;
+const uint8_t kGameOverFlag = 2;
+
+void PutUint32(uint32_t value, uint8_t* out) {
+  for (int i = 0; i < 4; i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+void PutUint64(uint64_t value, uint8_t* out) {
+  for (int i = 0; i < 8; i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+uint32_t GetUint32(const uint8_t* data) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= static_cast<uint32_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+uint64_t GetUint64(const uint8_t* data) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    value |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+}  // namespace
+
+size_t EncodeRequest(const MatchRequest& request, uint8_t* out) {
+  out[0] = request.type;
+  PutUint32(request.tag, out + 1);
+  if (request.type == kCreateGame) {
+    return kCreateGameSize;
+  }
+  PutUint32(request.game_id, out + 5);
+  out[9] = request.square;
+  return kPlayMoveSize;
+}
+
+size_t DecodeRequest(const uint8_t* data, size_t size,
+                     MatchRequest& request) {
+  if (size == 0) {
+    return 0;
+  }
+  if (data[0] == kCreateGame) {
+    if (size < kCreateGameSize) {
+      return 0;
+    }
+    request.type = kCreateGame;
+    request.tag = GetUint32(data + 1);
+    return kCreateGameSize;
+  }
+  if (data[0] == kPlayMove) {
+    if (size < kPlayMoveSize) {
+      return 0;
+    }
+    request.type = kPlayMove;
+    request.tag = GetUint32(data + 1);
+    request.game_id = GetUint32(data + 5);
+    request.square = data[9];
+    return kPlayMoveSize;
+  }
+  throw std::runtime_error("Unknown match request type");
+}
+
+size_t EncodeGameUpdate(const GameUpdate& update, uint8_t* out) {
+  out[0] = kGameUpdate;
+  PutUint32(update.tag, out + 1);
+  PutUint32(update.game_id, out + 5);
+  out[9] = update.status;
+  out[10] = static_cast<uint8_t>(
+      (update.position.is_white_turn ? kWhiteTurnFlag : 0)
+      | (update.is_game_over ? kGameOverFlag : 0));
+  PutUint64(update.position.black, out + 11);
+  PutUint64(update.position.white, out + 19);
+  return kGameUpdateSize;
+}
+
+size_t DecodeGameUpdate(const uint8_t* data, size_t size,
+                        GameUpdate& update) {
+  if (size < kGameUpdateSize) {
+    return 0;
+  }
+  if (data[0] != kGameUpdate || data[9] > kServerFull) {
+    throw std::runtime_error("Malformed game update");
+  }
+  update.tag = GetUint32(data + 1);
+  update.game_id = GetUint32(data + 5);
+  update.status = static_cast<MatchStatus>(data[9]);
+  update.position.is_white_turn = (data[10] & kWhiteTurnFlag) != 0;
+  update.is_game_over = (data[10] & kGameOverFlag) != 0;
+  update.position.black = GetUint64(data + 11);
+  update.position.white = GetUint64(data + 19);
+  return kGameUpdateSize;
+}
+
+}  // namespace othello
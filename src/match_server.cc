@@ -0,0 +1,520 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/match_server.h"
+
+#include <stdexcept>
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+namespace othello {
+
+namespace {
+
+const int kMaxEvents = 256;
+const size_t kReadBufferSize = 64 * 1024;
+// How many reads one connection gets per wakeup, so a busy connection cannot
+// keep the others waiting
+const int kMaxReadsPerWakeup = 8;
+// How long accepting stays paused after it failed, if no connection closes
+const std::chrono::milliseconds kAcceptRetryInterval{1000};
+
+void ThrowSystemError(const std::string& what) {
+  throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+}  // namespace
+
+struct MatchServer::Connection {
+  // The start of a request that has not been fully received yet
+  uint8_t partial[kMaxMessageSize];
+  size_t partial_size = 0;
+  std::vector<uint8_t> output;
+  size_t output_sent = 0;
+  uint32_t events = EPOLLIN;
+};
+
+MatchServer::MatchServer(Scoreboard& scoreboard,
+                         const MatchServerOptions& options)
+    : scoreboard_{scoreboard}, options_{options}, games_{options.max_games},
+      read_buffer_(kReadBufferSize) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    ThrowSystemError("Could not create the epoll instance");
+  }
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd_ < 0) {
+    close(epoll_fd_);
+    ThrowSystemError("Could not create the wake-up eventfd");
+  }
+  AddToEpoll(wake_fd_, EPOLLIN);
+  pending_scores_.reserve(options_.score_batch_size);
+}
+
+MatchServer::~MatchServer() {
+  for (size_t fd = 0; fd < connections_.size(); fd++) {
+    if (connections_[fd]) {
+      close(static_cast<int>(fd));
+    }
+  }
+  for (int fd : listen_fds_) {
+    close(fd);
+  }
+  for (const std::string& path : unix_paths_) {
+    unlink(path.c_str());
+  }
+  close(wake_fd_);
+  close(epoll_fd_);
+}
+
+uint16_t MatchServer::ListenTcp(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+  if (fd < 0) {
+    ThrowSystemError("Could not create a TCP socket");
+  }
+  const int enable = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), length) < 0
+      || listen(fd, SOMAXCONN) < 0
+      || getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) < 0) {
+    close(fd);
+    ThrowSystemError("Could not listen on TCP port " + std::to_string(port));
+  }
+  listen_fds_.push_back(fd);
+  AddToEpoll(fd, EPOLLIN);
+  return ntohs(address.sin_port);
+}
+
+void MatchServer::ListenUnix(const std::string& path) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("The Unix socket path is too long: " + path);
+  }
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+  if (fd < 0) {
+    ThrowSystemError("Could not create a Unix socket");
+  }
+  unlink(path.c_str()); // A socket left behind by an earlier server
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+      || listen(fd, SOMAXCONN) < 0) {
+    close(fd);
+    ThrowSystemError("Could not listen on " + path);
+  }
+  listen_fds_.push_back(fd);
+  unix_paths_.push_back(path);
+  AddToEpoll(fd, EPOLLIN);
+}
+
+void MatchServer::Run() {
+  epoll_event events[kMaxEvents];
+  while (!is_stopping_) {
+    const int num_events = epoll_wait(epoll_fd_, events, kMaxEvents,
+                                      GetWaitTimeout());
+    if (num_events < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ThrowSystemError("Waiting for socket events failed");
+    }
+
+    for (int i = 0; i < num_events; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == wake_fd_) {
+        uint64_t count;
+        while (read(wake_fd_, &count, sizeof(count)) > 0) {
+        }
+      } else if (std::find(listen_fds_.begin(), listen_fds_.end(), fd)
+                 != listen_fds_.end()) {
+        Accept(fd);
+      } else if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        HandleReadable(fd);
+      } else if (events[i].events & EPOLLOUT) {
+        Connection& connection = *connections_[static_cast<size_t>(fd)];
+        if (!SendOutput(fd, connection)) {
+          Close(fd);
+        } else {
+          UpdateEvents(fd, connection);
+        }
+      }
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!pending_scores_.empty()
+        && now >= oldest_pending_score_ + options_.score_flush_interval) {
+      FlushScores();
+    }
+    if (!is_accepting_ && now >= accept_retry_time_) {
+      SetAccepting(true);
+    }
+  }
+  FlushScores();
+  // Anything still waiting is lost with the server
+  num_scores_dropped_ += pending_scores_.size();
+  pending_scores_.clear();
+}
+
+void MatchServer::Stop() {
+  is_stopping_ = true;
+  const uint64_t one = 1;
+  if (write(wake_fd_, &one, sizeof(one)) < 0) {
+    // The eventfd is only full if a wake-up is already pending
+  }
+}
+
+MatchServerStats MatchServer::GetStats() const {
+  MatchServerStats stats;
+  stats.connections = num_connections_;
+  stats.games_created = num_games_created_;
+  stats.moves_played = num_moves_played_;
+  stats.games_finished = num_games_finished_;
+  stats.scores_dropped = num_scores_dropped_;
+  return stats;
+}
+
+void MatchServer::AddToEpoll(int fd, uint32_t events) {
+  epoll_event event;
+  std::memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    ThrowSystemError("Could not add a socket to epoll");
+  }
+}
+
+int MatchServer::GetWaitTimeout() const {
+  // Sleeps until the next event, or until the waiting scores are due or
+  // accepting is retried
+  const auto now = std::chrono::steady_clock::now();
+  auto due = std::chrono::steady_clock::time_point::max();
+  if (!pending_scores_.empty()) {
+    due = oldest_pending_score_ + options_.score_flush_interval;
+  }
+  if (!is_accepting_) {
+    due = std::min(due, accept_retry_time_);
+  }
+  if (due == std::chrono::steady_clock::time_point::max()) {
+    return -1;
+  }
+  // Rounded up, so the timer is never woken for just before it is due
+  const long long wait_ms = std::chrono::duration_cast<
+      std::chrono::milliseconds>(due - now).count() + 1;
+  return static_cast<int>(std::max<long long>(0, wait_ms));
+}
+
+void MatchServer::Accept(int listen_fd) {
+  while (true) {
+    const int fd = accept4(listen_fd, nullptr, nullptr,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return; // Every waiting connection was accepted
+      }
+      if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) {
+        continue; // Only this attempt or this connection failed
+      }
+      // Out of file descriptors or memory. The listening sockets are
+      // level-triggered, so they would wake epoll_wait again straight away;
+      // instead they are left out until a connection closes, and waiting
+      // clients stay in the backlog.
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= last_accept_error_log_ + kAcceptRetryInterval) {
+        last_accept_error_log_ = now; // Logged at most once per interval
+        std::cerr << "Match server stopped accepting connections: "
+                  << std::strerror(errno) << std::endl;
+      }
+      SetAccepting(false);
+      return;
+    }
+    // Answers are small, so they should not wait for more to send
+    const int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    const size_t index = static_cast<size_t>(fd);
+    if (connections_.size() <= index) {
+      connections_.resize(index + 1);
+    }
+    connections_[index].reset(new Connection());
+    AddToEpoll(fd, EPOLLIN);
+    num_connections_++;
+  }
+}
+
+void MatchServer::SetAccepting(bool is_accepting) {
+  is_accepting_ = is_accepting;
+  accept_retry_time_ = std::chrono::steady_clock::now()
+      + kAcceptRetryInterval;
+  for (int fd : listen_fds_) {
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = is_accepting ? static_cast<uint32_t>(EPOLLIN) : 0u;
+    event.data.fd = fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+  }
+}
+
+void MatchServer::HandleReadable(int fd) {
+  Connection& connection = *connections_[static_cast<size_t>(fd)];
+  uint8_t* buffer = read_buffer_.data();
+
+  for (int reads = 0; reads < kMaxReadsPerWakeup
+       && connection.output.size() - connection.output_sent
+          <= options_.max_pending_output; reads++) {
+    // Requests can be split between reads, so the start of an unfinished
+    // one is put in front of the new bytes
+    std::memcpy(buffer, connection.partial, connection.partial_size);
+    const ssize_t num_read = read(fd, buffer + connection.partial_size,
+                                  read_buffer_.size()
+                                      - connection.partial_size);
+    if (num_read == 0) {
+      Close(fd);
+      return;
+    }
+    if (num_read < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      Close(fd);
+      return;
+    }
+
+    const size_t size = connection.partial_size
+        + static_cast<size_t>(num_read);
+    size_t offset = 0;
+    try {
+      MatchRequest request;
+      size_t used;
+      while ((used = DecodeRequest(buffer + offset, size - offset, request))
+             > 0) {
+        HandleRequest(fd, connection, request);
+        offset += used;
+      }
+    } catch (const std::runtime_error&) {
+      Close(fd); // A client that breaks the protocol is disconnected
+      return;
+    }
+    connection.partial_size = size - offset;
+    std::memcpy(connection.partial, buffer + offset, connection.partial_size);
+  }
+
+  if (!SendOutput(fd, connection)) {
+    Close(fd);
+    return;
+  }
+  UpdateEvents(fd, connection);
+}
+
+void MatchServer::HandleRequest(int fd, Connection& connection,
+                                const MatchRequest& request) {
+  GameUpdate update;
+  update.tag = request.tag;
+
+  if (request.type == kCreateGame) {
+    update.game_id = games_.Create(fd);
+    if (update.game_id == GamePool::kNoGame) {
+      update.status = kServerFull;
+    } else {
+      update.position = *games_.Find(update.game_id, fd);
+      num_games_created_++;
+    }
+  } else {
+    update.game_id = request.game_id;
+    logic::Position* position = games_.Find(request.game_id, fd);
+    if (position == nullptr) {
+      update.status = kUnknownGame;
+    } else if (request.square >= logic::kNumSquares
+               || !(logic::GetMoveMask(*position) >> request.square & 1)) {
+      update.status = kIllegalMove;
+      update.position = *position;
+    } else {
+      *position = logic::ApplyMove(*position, request.square);
+      if (logic::GetMoveMask(*position) == 0) {
+        // The server plays forced passes, so a client only ever has to
+        // answer positions with a legal move in them
+        if (logic::IsTerminal(*position)) {
+          update.is_game_over = true;
+        } else {
+          *position = logic::ApplyMove(*position, logic::kPassMove);
+        }
+      }
+      update.position = *position;
+      num_moves_played_++;
+      if (update.is_game_over) {
+        QueueScore(*position);
+        games_.Release(request.game_id);
+      }
+    }
+  }
+
+  const size_t end = connection.output.size();
+  connection.output.resize(end + kGameUpdateSize);
+  EncodeGameUpdate(update, connection.output.data() + end);
+}
+
+bool MatchServer::SendOutput(int fd, Connection& connection) {
+  while (connection.output_sent < connection.output.size()) {
+    const ssize_t num_sent = send(fd,
+        connection.output.data() + connection.output_sent,
+        connection.output.size() - connection.output_sent, MSG_NOSIGNAL);
+    if (num_sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    connection.output_sent += static_cast<size_t>(num_sent);
+  }
+  // Everything was sent, so the buffer is reused from the start
+  connection.output.clear();
+  connection.output_sent = 0;
+  return true;
+}
+
+void MatchServer::UpdateEvents(int fd, Connection& connection) {
+  const size_t pending = connection.output.size() - connection.output_sent;
+  uint32_t events = 0;
+  if (pending <= options_.max_pending_output) {
+    events |= EPOLLIN;
+  }
+  if (pending > 0) {
+    events |= EPOLLOUT;
+  }
+  if (events == connection.events) {
+    return;
+  }
+  connection.events = events;
+  epoll_event event;
+  std::memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.fd = fd;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+}
+
+void MatchServer::Close(int fd) {
+  // Closing the descriptor also removes it from epoll
+  close(fd);
+  connections_[static_cast<size_t>(fd)].reset();
+  games_.ReleaseAll(fd);
+  if (!is_accepting_) {
+    SetAccepting(true); // A file descriptor is free again
+  }
+}
+
+void MatchServer::QueueScore(const logic::Position& final_position) {
+  const int black_score = logic::CountDiscs(final_position.black);
+  const int white_score = logic::CountDiscs(final_position.white);
+  if (pending_scores_.empty()) {
+    oldest_pending_score_ = std::chrono::steady_clock::now();
+  }
+  // Recorded the same way the app records its games
+  if (black_score == white_score) {
+    pending_scores_.push_back({"tie", "tie", white_score});
+  } else if (black_score > white_score) {
+    pending_scores_.push_back({"black", "white", black_score});
+  } else {
+    pending_scores_.push_back({"white", "black", white_score});
+  }
+  num_games_finished_++;
+  // While the scoreboard is failing, only the retry timer writes, so a full
+  // batch does not retry on every finished game
+  if (pending_scores_.size() >= options_.score_batch_size
+      && !is_scoreboard_failing_) {
+    FlushScores();
+  }
+}
+
+void MatchServer::FlushScores() {
+  if (pending_scores_.empty()) {
+    return;
+  }
+  try {
+    scoreboard_.AddGamesToScoreBoard(pending_scores_);
+  } catch (const std::exception& error) {
+    // The batch is added all or nothing, so it can be retried as it is
+    if (!is_scoreboard_failing_) {
+      std::cerr << "Match server could not write to the scoreboard, "
+                   "retrying: " << error.what() << std::endl;
+    }
+    is_scoreboard_failing_ = true;
+    oldest_pending_score_ = std::chrono::steady_clock::now();
+    if (pending_scores_.size() > options_.max_pending_scores) {
+      const size_t num_dropped = pending_scores_.size()
+          - options_.max_pending_scores;
+      pending_scores_.erase(pending_scores_.begin(),
+          pending_scores_.begin() + static_cast<std::ptrdiff_t>(num_dropped));
+      num_scores_dropped_ += num_dropped;
+    }
+    return;
+  }
+  if (is_scoreboard_failing_) {
+    std::cerr << "Match server is writing to the scoreboard again"
+              << std::endl;
+  }
+  pending_scores_.clear();
+  is_scoreboard_failing_ = false;
+}
+
+}  // namespace othello
+
+#else
+
+namespace othello {
+
+struct MatchServer::Connection {};
+
+MatchServer::MatchServer(Scoreboard& scoreboard,
+                         const MatchServerOptions& options)
+    : scoreboard_{scoreboard}, options_{options}, games_{options.max_games} {
+  throw std::runtime_error("The match server needs epoll, which is Linux only");
+}
+
+MatchServer::~MatchServer() = default;
+
+uint16_t MatchServer::ListenTcp(uint16_t) {
+  return 0;
+}
+
+void MatchServer::ListenUnix(const std::string&) {}
+
+void MatchServer::Run() {}
+
+void MatchServer::Stop() {}
+
+MatchServerStats MatchServer::GetStats() const {
+  return MatchServerStats();
+}
+
+}  // namespace othello
+
+#endif  // __linux__
@@ -0,0 +1,324 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/mcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace logic {
+
+namespace {
+
+// The exploration constant of UCT, sqrt(2) for rewards between 0 and 1
+const double kExploration = 1.41421356;
+// A game lasts at most 60 moves, and there can be a pass after each of them
+const int kMaxDepth = 2 * kNumSquares + 2;
+// How many iterations a thread runs between looks at the clock
+const int kIterationsPerClockCheck = 64;
+// Rewards, in half-points, for the side that played into a node
+const int32_t kWinReward = 2;
+const int32_t kDrawReward = 1;
+
+}  // namespace
+
+MctsEngine::MctsEngine(size_t max_nodes, int num_threads, uint64_t seed)
+    : max_nodes_{std::min<size_t>(std::max<size_t>(max_nodes, 1),
+                                  std::numeric_limits<uint32_t>::max())},
+      num_threads_{std::max(num_threads, 1)},
+      seed_{seed},
+      root_position_{InitialPosition()},
+      nodes_{std::make_unique<Node[]>(max_nodes_)},
+      spare_nodes_{std::make_unique<Node[]>(max_nodes_)} {
+  ResetTree();
+}
+
+void MctsEngine::SetPosition(const Position& position) {
+  if (position.black == root_position_.black
+      && position.white == root_position_.white
+      && position.is_white_turn == root_position_.is_white_turn) {
+    return; // Same position, so the tree can be searched further
+  }
+  root_position_ = position;
+  ResetTree();
+}
+
+const Position& MctsEngine::GetPosition() const {
+  return root_position_;
+}
+
+int MctsEngine::Search(long long playouts) {
+  return RunSearch(playouts, std::chrono::steady_clock::time_point::max());
+}
+
+int MctsEngine::SearchFor(std::chrono::milliseconds think_time) {
+  return RunSearch(std::numeric_limits<long long>::max(),
+                   std::chrono::steady_clock::now() + think_time);
+}
+
+void MctsEngine::Advance(int square) {
+  const Node& root = nodes_[0];
+  uint32_t kept_child = 0; // The root is never a child, so 0 means none
+  if (root.state.load(std::memory_order_acquire) == kExpanded) {
+    const uint32_t first = root.first_child.load(std::memory_order_relaxed);
+    for (uint32_t i = first; i < first + root.num_children; i++) {
+      if (nodes_[i].move == square) {
+        kept_child = i;
+      }
+    }
+  }
+  root_position_ = ApplyMove(root_position_, square);
+  if (kept_child == 0) {
+    ResetTree();
+    return;
+  }
+
+  // Copies the kept subtree into the spare arena breadth-first. The arena
+  // doubles as the queue: while a copied node waits to be visited, its
+  // first_child holds its index in the old arena.
+  auto copy_node = [this](uint32_t from, uint32_t to) {
+    const Node& source = nodes_[from];
+    Node& target = spare_nodes_[to];
+    target.visits.store(source.visits.load());
+    target.score.store(source.score.load());
+    target.state.store(source.state.load());
+    target.first_child.store(from);
+    target.num_children = source.num_children;
+    target.move = source.move;
+  };
+  copy_node(kept_child, 0);
+  uint32_t used = 1;
+  for (uint32_t i = 0; i < used; i++) {
+    Node& copied = spare_nodes_[i];
+    const Node& original = nodes_[copied.first_child.load()];
+    if (copied.state.load() != kExpanded) {
+      copied.state.store(kUnexpanded);
+      copied.first_child.store(0);
+      copied.num_children = 0;
+      continue;
+    }
+    const uint32_t first = original.first_child.load();
+    copied.first_child.store(used);
+    for (uint32_t child = first; child < first + original.num_children;
+         child++) {
+      copy_node(child, used++);
+    }
+  }
+  nodes_.swap(spare_nodes_);
+  nodes_used_.store(used);
+}
+
+long long MctsEngine::GetRootVisits() const {
+  return nodes_[0].visits.load();
+}
+
+const MctsStats& MctsEngine::GetStats() const {
+  return stats_;
+}
+
+void MctsEngine::Worker(int thread_index, long long playouts,
+                        std::chrono::steady_clock::time_point deadline) {
+  XorShift64 rng(seed_ + searches_run_ * static_cast<uint64_t>(num_threads_)
+                 + static_cast<uint64_t>(thread_index));
+  long long iterations = 0;
+  while (playouts_started_.fetch_add(1, std::memory_order_relaxed)
+         < playouts) {
+    if (iterations % kIterationsPerClockCheck == 0
+        && std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+    RunIteration(rng);
+    iterations++;
+  }
+  playouts_finished_.fetch_add(iterations, std::memory_order_relaxed);
+}
+
+void MctsEngine::RunIteration(XorShift64& rng) {
+  // The nodes walked through and, for each of them, whether white played
+  // the move leading into it
+  uint32_t path[kMaxDepth];
+  bool white_moved[kMaxDepth];
+  int depth = 0;
+
+  Position position = root_position_;
+  uint32_t node = 0;
+  nodes_[node].visits.fetch_add(1, std::memory_order_relaxed);
+  path[depth] = node;
+  white_moved[depth++] = !position.is_white_turn;
+
+  for (;;) {
+    const uint8_t state = nodes_[node].state.load(std::memory_order_acquire);
+    bool expanded_here = false;
+    if (state == kUnexpanded) {
+      if (!Expand(node, position)) {
+        break;
+      }
+      expanded_here = true;
+    } else if (state == kExpanding) {
+      break; // Another thread is adding the children, so play out from here
+    }
+    if (nodes_[node].num_children == 0) {
+      break; // The game is over at this node
+    }
+
+    const uint32_t child = SelectChild(node);
+    // The visit is counted now and the score only after the playout, which
+    // is the virtual loss that steers other threads to other children.
+    nodes_[child].visits.fetch_add(1, std::memory_order_relaxed);
+    white_moved[depth] = position.is_white_turn;
+    path[depth++] = child;
+    position = ApplyMove(position, nodes_[child].move);
+    node = child;
+    if (expanded_here) {
+      break; // Play out from the first new child
+    }
+  }
+
+  const int disc_differential = RandomPlayout(position, rng);
+  for (int i = 0; i < depth; i++) {
+    const int mover_differential =
+        white_moved[i] ? -disc_differential : disc_differential;
+    if (mover_differential > 0) {
+      nodes_[path[i]].score.fetch_add(kWinReward, std::memory_order_relaxed);
+    } else if (mover_differential == 0) {
+      nodes_[path[i]].score.fetch_add(kDrawReward, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool MctsEngine::Expand(uint32_t node, const Position& position) {
+  Node& parent = nodes_[node];
+  uint8_t expected = kUnexpanded;
+  if (!parent.state.compare_exchange_strong(expected, kExpanding,
+                                            std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  uint64_t moves = GetMoveMask(position);
+  uint32_t count = static_cast<uint32_t>(CountDiscs(moves));
+  const bool must_pass =
+      moves == 0 && GetMoveMask(ApplyMove(position, kPassMove)) != 0;
+  if (must_pass) {
+    count = 1;
+  }
+
+  uint32_t first = 0;
+  if (count > 0) {
+    if (nodes_used_.load(std::memory_order_relaxed) + count > max_nodes_) {
+      parent.state.store(kUnexpanded, std::memory_order_release);
+      return false;
+    }
+    first = nodes_used_.fetch_add(count, std::memory_order_relaxed);
+    if (first + count > max_nodes_) {
+      // Another thread took the last nodes between the check and the add
+      parent.state.store(kUnexpanded, std::memory_order_release);
+      return false;
+    }
+    for (uint32_t i = first; i < first + count; i++) {
+      Node& child = nodes_[i];
+      child.visits.store(0, std::memory_order_relaxed);
+      child.score.store(0, std::memory_order_relaxed);
+      child.first_child.store(0, std::memory_order_relaxed);
+      child.state.store(kUnexpanded, std::memory_order_relaxed);
+      child.num_children = 0;
+      if (must_pass) {
+        child.move = static_cast<uint8_t>(kPassMove);
+      } else {
+        child.move = static_cast<uint8_t>(LowestSquare(moves));
+        moves &= moves - 1;
+      }
+    }
+  }
+
+  parent.first_child.store(first, std::memory_order_relaxed);
+  parent.num_children = static_cast<uint8_t>(count);
+  parent.state.store(kExpanded, std::memory_order_release);
+  return true;
+}
+
+uint32_t MctsEngine::SelectChild(uint32_t node) const {
+  const Node& parent = nodes_[node];
+  const uint32_t first = parent.first_child.load(std::memory_order_relaxed);
+  const double log_parent_visits = std::log(static_cast<double>(
+      std::max(parent.visits.load(std::memory_order_relaxed), 1)));
+
+  uint32_t best_child = first;
+  double best_value = -1;
+  for (uint32_t child = first; child < first + parent.num_children; child++) {
+    const int32_t visits = nodes_[child].visits.load(std::memory_order_relaxed);
+    if (visits == 0) {
+      return child; // Every child is tried once before any is tried twice
+    }
+    const double score = nodes_[child].score.load(std::memory_order_relaxed);
+    const double value = score / (kWinReward * visits)
+        + kExploration * std::sqrt(log_parent_visits / visits);
+    if (value > best_value) {
+      best_value = value;
+      best_child = child;
+    }
+  }
+  return best_child;
+}
+
+int MctsEngine::RunSearch(long long playouts,
+                          std::chrono::steady_clock::time_point deadline) {
+  const auto start = std::chrono::steady_clock::now();
+  playouts_started_.store(0);
+  playouts_finished_.store(0);
+
+  std::vector<std::thread> helpers;
+  for (int i = 1; i < num_threads_; i++) {
+    helpers.emplace_back(&MctsEngine::Worker, this, i, playouts, deadline);
+  }
+  Worker(0, playouts, deadline);
+  for (auto& helper : helpers) {
+    helper.join();
+  }
+  searches_run_++;
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  stats_.playouts = playouts_finished_.load();
+  stats_.seconds = elapsed.count();
+  stats_.playouts_per_second =
+      stats_.seconds > 0 ? static_cast<double>(stats_.playouts) / stats_.seconds
+                         : 0;
+  stats_.nodes_used = std::min<size_t>(nodes_used_.load(), max_nodes_);
+  stats_.bytes_per_node = sizeof(Node);
+  stats_.bytes_used = stats_.nodes_used * stats_.bytes_per_node;
+  return BestMove();
+}
+
+int MctsEngine::BestMove() const {
+  const Node& root = nodes_[0];
+  if (root.state.load(std::memory_order_acquire) != kExpanded
+      || root.num_children == 0) {
+    // Nothing was searched, so fall back to any legal move
+    const uint64_t moves = GetMoveMask(root_position_);
+    return moves == 0 ? kPassMove : LowestSquare(moves);
+  }
+
+  const uint32_t first = root.first_child.load(std::memory_order_relaxed);
+  uint32_t best_child = first;
+  for (uint32_t child = first; child < first + root.num_children; child++) {
+    if (nodes_[child].visits.load() > nodes_[best_child].visits.load()) {
+      best_child = child;
+    }
+  }
+  return nodes_[best_child].move;
+}
+
+void MctsEngine::ResetTree() {
+  Node& root = nodes_[0];
+  root.visits.store(0);
+  root.score.store(0);
+  root.first_child.store(0);
+  root.state.store(kUnexpanded);
+  root.num_children = 0;
+  root.move = static_cast<uint8_t>(kPassMove);
+  nodes_used_.store(1);
+}
+
+}  // namespace logic
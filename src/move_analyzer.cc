@@ -0,0 +1,161 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/move_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace logic {
+
+namespace {
+
+// How many playouts are run between publishing a score and checking whether
+// the job was cancelled
+const int kPlayoutsPerBatch = 64;
+
+uint64_t PackScore(uint32_t generation, float score) {
+  uint32_t score_bits;
+  std::memcpy(&score_bits, &score, sizeof(score_bits));
+  return (static_cast<uint64_t>(generation) << 32) | score_bits;
+}
+
+}  // namespace
+
+MoveAnalyzer::MoveAnalyzer(int num_threads, int playouts_per_move,
+                           AnalysisCache* cache)
+    : playouts_per_move_{std::max(playouts_per_move, 1)}, cache_{cache} {
+  for (auto& score : scores_) {
+    score.store(0);
+  }
+  for (int i = 0; i < std::max(num_threads, 1); i++) {
+    workers_.emplace_back(&MoveAnalyzer::WorkerLoop, this);
+  }
+}
+
+MoveAnalyzer::~MoveAnalyzer() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    is_stopping_ = true;
+    generation_++; // Makes running jobs stop at their next batch
+  }
+  queue_changed_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void MoveAnalyzer::Analyze(const Position& position) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.clear();
+    const uint32_t generation = ++generation_;
+    for (uint64_t moves = GetMoveMask(position); moves != 0;
+         moves &= moves - 1) {
+      const int square = LowestSquare(moves);
+      // The cache holds the chance of winning of the side that replies, and
+      // stores bigger playout counts as its maximum depth
+      CachedAnalysis cached;
+      if (cache_ != nullptr
+          && cache_->Lookup(ApplyMove(position, square), cached,
+                            AnalysisKind::kPlayouts)
+          && cached.depth >= std::min(playouts_per_move_,
+                                      AnalysisCache::kMaxDepth)) {
+        PublishScore(square, generation, 1 - static_cast<float>(cached.score)
+            / static_cast<float>(kPlayoutScoreScale));
+        continue;
+      }
+      queue_.push_back({position, square, generation});
+    }
+  }
+  queue_changed_.notify_all();
+}
+
+void MoveAnalyzer::Cancel() {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  queue_.clear();
+  generation_++;
+}
+
+bool MoveAnalyzer::TryGetScore(int square, float& score) const {
+  if (square < 0 || square >= kNumSquares) {
+    return false;
+  }
+  const uint64_t packed = scores_[square].load(std::memory_order_acquire);
+  if (static_cast<uint32_t>(packed >> 32)
+      != generation_.load(std::memory_order_acquire)) {
+    return false; // Nothing published for this position yet
+  }
+  const uint32_t score_bits = static_cast<uint32_t>(packed);
+  std::memcpy(&score, &score_bits, sizeof(score));
+  return true;
+}
+
+void MoveAnalyzer::WorkerLoop() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_changed_.wait(lock, [this] {
+        return is_stopping_ || !queue_.empty();
+      });
+      if (is_stopping_) {
+        return;
+      }
+      job = queue_.front();
+      queue_.pop_front();
+    }
+    RunJob(job);
+  }
+}
+
+void MoveAnalyzer::RunJob(const Job& job) {
+  const Position after_move = ApplyMove(job.position, job.square);
+  XorShift64 rng((static_cast<uint64_t>(job.generation) << 8)
+                 ^ static_cast<uint64_t>(job.square));
+  // Points for the side that made the move: 2 for a win and 1 for a draw
+  long long points = 0;
+  int playouts = 0;
+  float score = 0;
+  while (playouts < playouts_per_move_) {
+    if (generation_.load(std::memory_order_relaxed) != job.generation) {
+      return; // A newer position was asked for, so this score is stale
+    }
+    const int batch_end = std::min(playouts + kPlayoutsPerBatch,
+                                   playouts_per_move_);
+    for (; playouts < batch_end; playouts++) {
+      int differential = RandomPlayout(after_move, rng);
+      if (job.position.is_white_turn) {
+        differential = -differential;
+      }
+      points += differential > 0 ? 2 : (differential == 0 ? 1 : 0);
+    }
+    score = static_cast<float>(points) / static_cast<float>(2 * playouts);
+    PublishScore(job.square, job.generation, score);
+  }
+
+  if (cache_ != nullptr) {
+    // The playouts do not tell which reply is best, so best_move is kNoMove
+    CachedAnalysis analysis;
+    analysis.kind = AnalysisKind::kPlayouts;
+    analysis.depth = playouts_per_move_;
+    analysis.score = static_cast<int>(std::lround(
+        (1 - score) * static_cast<float>(kPlayoutScoreScale)));
+    cache_->Store(after_move, analysis);
+  }
+}
+
+void MoveAnalyzer::PublishScore(int square, uint32_t generation,
+                                float score) {
+  // A stale job can finish its batch after a newer job for the same square
+  // has published, so older generations never replace newer ones
+  const uint64_t packed = PackScore(generation, score);
+  uint64_t current = scores_[square].load(std::memory_order_relaxed);
+  while (static_cast<uint32_t>(current >> 32) <= generation
+         && !scores_[square].compare_exchange_weak(
+                current, packed, std::memory_order_release,
+                std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace logic
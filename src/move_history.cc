@@ -0,0 +1,92 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/move_history.h"
+
+namespace logic {
+
+namespace {
+
+const char kWhite[] = "white";
+const char kBlack[] = "black";
+
+}  // namespace
+
+void MoveHistory::Record(const Position& before, int square,
+                         bool is_white_turn_after) {
+  const uint64_t own = before.is_white_turn ? before.white : before.black;
+  const uint64_t opponent = before.is_white_turn ? before.black : before.white;
+
+  moves_.resize(ply_); // Drops the moves that were undone
+  MoveRecord record;
+  record.flipped = GetFlipMask(own, opponent, square);
+  record.square = static_cast<uint8_t>(square);
+  record.was_white_turn = before.is_white_turn;
+  record.is_white_turn_after = is_white_turn_after;
+  moves_.push_back(record);
+  ply_++;
+}
+
+bool MoveHistory::Undo(vector<vector<string>>& game_board_,
+                       bool& is_white_turn_) {
+  if (ply_ == 0) {
+    return false;
+  }
+  const MoveRecord& record = moves_[--ply_];
+  const char* opponent_color = record.was_white_turn ? kBlack : kWhite;
+
+  game_board_[record.square / kBoardSize][record.square % kBoardSize] = "";
+  // Only the flipped discs are visited, so this never scans the whole board
+  for (uint64_t flipped = record.flipped; flipped != 0;
+       flipped &= flipped - 1) {
+    const int square = LowestSquare(flipped);
+    game_board_[square / kBoardSize][square % kBoardSize] = opponent_color;
+  }
+  is_white_turn_ = record.was_white_turn;
+  return true;
+}
+
+bool MoveHistory::Redo(vector<vector<string>>& game_board_,
+                       bool& is_white_turn_) {
+  if (ply_ == moves_.size()) {
+    return false;
+  }
+  const MoveRecord& record = moves_[ply_++];
+  const char* own_color = record.was_white_turn ? kWhite : kBlack;
+
+  game_board_[record.square / kBoardSize][record.square % kBoardSize] =
+      own_color;
+  for (uint64_t flipped = record.flipped; flipped != 0;
+       flipped &= flipped - 1) {
+    const int square = LowestSquare(flipped);
+    game_board_[square / kBoardSize][square % kBoardSize] = own_color;
+  }
+  is_white_turn_ = record.is_white_turn_after;
+  return true;
+}
+
+void MoveHistory::JumpToPly(size_t ply, vector<vector<string>>& game_board_,
+                            bool& is_white_turn_) {
+  while (ply_ > ply && Undo(game_board_, is_white_turn_)) {
+  }
+  while (ply_ < ply && Redo(game_board_, is_white_turn_)) {
+  }
+}
+
+size_t MoveHistory::GetPly() const {
+  return ply_;
+}
+
+size_t MoveHistory::GetNumPlies() const {
+  return moves_.size();
+}
+
+int MoveHistory::GetSquare(size_t ply) const {
+  return moves_[ply].square;
+}
+
+void MoveHistory::Clear() {
+  moves_.clear();
+  ply_ = 0;
+}
+
+}  // namespace logic
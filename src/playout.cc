@@ -0,0 +1,105 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/playout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace logic {
+
+namespace {
+
+// How many playouts share one random number generator. This is fixed, and
+// not derived from the number of threads, so that results are reproducible.
+const long long kPlayoutsPerChunk = 1024;
+
+// Plays the chunks handed out by next_chunk until there are none left.
+void PlayChunks(const Position& position, long long num_playouts,
+                uint64_t stream_key, std::atomic<long long>& next_chunk,
+                PlayoutResult& thread_result) {
+  // Counted locally so that threads do not share cache lines while playing
+  PlayoutResult result;
+  const long long num_chunks =
+      (num_playouts + kPlayoutsPerChunk - 1) / kPlayoutsPerChunk;
+  for (long long chunk = next_chunk++; chunk < num_chunks;
+       chunk = next_chunk++) {
+    XorShift64 rng(stream_key + static_cast<uint64_t>(chunk));
+    const long long end =
+        std::min(num_playouts, (chunk + 1) * kPlayoutsPerChunk);
+    for (long long i = chunk * kPlayoutsPerChunk; i < end; i++) {
+      int differential = RandomPlayout(position, rng);
+      if (position.is_white_turn) {
+        differential = -differential;
+      }
+      if (differential > 0) {
+        result.wins++;
+      } else if (differential < 0) {
+        result.losses++;
+      } else {
+        result.draws++;
+      }
+      result.disc_differentials[static_cast<size_t>(
+          differential + kMaxDiscDifferential)]++;
+      result.playouts++;
+    }
+  }
+  thread_result = result;
+}
+
+}  // namespace
+
+PlayoutResult PlayoutBatch(const Position& position, long long num_playouts,
+                           uint64_t seed, int num_threads) {
+  const auto start = std::chrono::steady_clock::now();
+  if (num_threads <= 0) {
+    num_threads = std::max(1, static_cast<int>(
+        std::thread::hardware_concurrency()));
+  }
+
+  // Scrambling the seed once keeps the chunk generators of nearby seeds
+  // from overlapping.
+  XorShift64 seed_scrambler(seed);
+  const uint64_t stream_key = seed_scrambler.Next();
+  std::atomic<long long> next_chunk{0};
+
+  // Every thread counts into its own result; since the counts are simply
+  // added together, the order the chunks finish in does not matter.
+  std::vector<PlayoutResult> thread_results(
+      static_cast<size_t>(num_threads));
+  std::vector<std::thread> helpers;
+  for (size_t i = 1; i < thread_results.size(); i++) {
+    helpers.emplace_back(PlayChunks, std::cref(position), num_playouts,
+                         stream_key, std::ref(next_chunk),
+                         std::ref(thread_results[i]));
+  }
+  PlayChunks(position, num_playouts, stream_key, next_chunk,
+             thread_results[0]);
+  for (auto& helper : helpers) {
+    helper.join();
+  }
+
+  PlayoutResult result;
+  for (const PlayoutResult& thread_result : thread_results) {
+    result.playouts += thread_result.playouts;
+    result.wins += thread_result.wins;
+    result.draws += thread_result.draws;
+    result.losses += thread_result.losses;
+    for (size_t i = 0; i < result.disc_differentials.size(); i++) {
+      result.disc_differentials[i] += thread_result.disc_differentials[i];
+    }
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  result.playouts_per_second =
+      result.seconds > 0 ? static_cast<double>(result.playouts) / result.seconds
+                         : 0;
+  return result;
+}
+
+}  // namespace logic
@@ -2,20 +2,143 @@
 
 #include <mylibrary/scoreboard.h>
 
+#include <algorithm>
+
 namespace othello {
 
- Scoreboard::Scoreboard(const std::string& db_path) : db_{db_path} {
+namespace {
+
+// Orders entries so that std::push_heap builds a min-heap on score.
+bool HigherScore(const ScoreEntry& first, const ScoreEntry& second) {
+  return first.score > second.score;
+}
+
+// Adds one game to the totals of a player.
+void AddGameToStats(const ScoreEntry& entry, const std::string& player,
+                    PlayerStats& stats) {
+  if (entry.winner == entry.loser) {
+    stats.ties++;
+  } else if (entry.winner == player) {
+    stats.wins++;
+    stats.best_score = std::max(stats.best_score, entry.score);
+  } else {
+    stats.losses++;
+  }
+}
+
+}  // namespace
+
+ Scoreboard::Scoreboard(const std::string& db_path, const size_t top_k)
+     : db_{db_path}, top_k_{top_k} {
     db_ << "CREATE TABLE if not exists scoreboard (\n"
            "  winner  TEXT NOT NULL,\n"
            "  loser  TEXT NOT NULL,\n"
            "  score INTEGER NOT NULL\n"
            ");";
+
+    // The whole table is read once here; after this, reads come from memory
+    db_ << "select winner, loser, score from scoreboard;"
+        >> [this](std::string winner, std::string loser, int score) {
+             AddToCache({winner, loser, score});
+           };
  }
 
  void Scoreboard::AddWinnerToScoreBoard(const std::string& winner,
      const std::string& loser, const int score) {
+   // If the insert throws, the cache is left untouched and stays consistent
    db_ << "insert into scoreboard (winner,loser,score) values (?,?,?);"
      << winner << loser << score;
+   AddToCache({winner, loser, score});
+ }
+
+ void Scoreboard::AddGamesToScoreBoard(
+     const std::vector<ScoreEntry>& entries) {
+   if (entries.empty()) {
+     return;
+   }
+   db_ << "begin;";
+   try {
+     for (const ScoreEntry& entry : entries) {
+       db_ << "insert into scoreboard (winner,loser,score) values (?,?,?);"
+         << entry.winner << entry.loser << entry.score;
+     }
+     db_ << "commit;";
+   } catch (...) {
+     try {
+       db_ << "rollback;";
+     } catch (...) {
+       // The insert's error is the one worth reporting
+     }
+     throw;
+   }
+   for (const ScoreEntry& entry : entries) {
+     AddToCache(entry);
+   }
+ }
+
+ std::vector<ScoreEntry> Scoreboard::GetTopScores() const {
+   std::vector<ScoreEntry> top_scores = top_scores_;
+   std::sort(top_scores.begin(), top_scores.end(), HigherScore);
+   return top_scores;
+ }
+
+ PlayerStats Scoreboard::GetPlayerStats(const std::string& player) const {
+   auto stats = player_stats_.find(player);
+   return stats == player_stats_.end() ? PlayerStats() : stats->second;
+ }
+
+ size_t Scoreboard::GetNumGames() const {
+   return num_games_;
+ }
+
+ std::vector<ScoreEntry> Scoreboard::QueryTopScores() {
+   std::vector<ScoreEntry> top_scores;
+   db_ << "select winner, loser, score from scoreboard "
+          "order by score desc limit ?;"
+       << static_cast<int>(top_k_)
+       >> [&top_scores](std::string winner, std::string loser, int score) {
+            top_scores.push_back({winner, loser, score});
+          };
+   return top_scores;
+ }
+
+ PlayerStats Scoreboard::QueryPlayerStats(const std::string& player) {
+   PlayerStats stats;
+   db_ << "select winner, loser, score from scoreboard "
+          "where winner = ? or loser = ?;"
+       << player << player
+       >> [&stats, &player](std::string winner, std::string loser,
+                            int score) {
+            AddGameToStats({winner, loser, score}, player, stats);
+          };
+   return stats;
+ }
+
+ size_t Scoreboard::QueryNumGames() {
+   int num_games = 0;
+   db_ << "select count(*) from scoreboard;" >> num_games;
+   return static_cast<size_t>(num_games);
+ }
+
+ void Scoreboard::AddToCache(const ScoreEntry& entry) {
+   num_games_++;
+   AddGameToStats(entry, entry.winner, player_stats_[entry.winner]);
+   if (entry.loser != entry.winner) {
+     AddGameToStats(entry, entry.loser, player_stats_[entry.loser]);
+   }
+
+   if (top_k_ == 0) {
+     return;
+   }
+   if (top_scores_.size() < top_k_) {
+     top_scores_.push_back(entry);
+     std::push_heap(top_scores_.begin(), top_scores_.end(), HigherScore);
+   } else if (entry.score > top_scores_.front().score) {
+     // Replaces the lowest of the top scores with the new one
+     std::pop_heap(top_scores_.begin(), top_scores_.end(), HigherScore);
+     top_scores_.back() = entry;
+     std::push_heap(top_scores_.begin(), top_scores_.end(), HigherScore);
+   }
  }
 
 }  // namespace mylibrary
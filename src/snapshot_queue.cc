@@ -0,0 +1,67 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "mylibrary/snapshot_queue.h"
+
+namespace logic {
+
+SnapshotQueue::SnapshotQueue(size_t capacity) {
+  size_t rounded_capacity = 2;
+  while (rounded_capacity < capacity) {
+    rounded_capacity *= 2;
+  }
+  mask_ = rounded_capacity - 1;
+  cells_ = std::unique_ptr<Cell[]>(new Cell[rounded_capacity]);
+  for (size_t i = 0; i < rounded_capacity; i++) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool SnapshotQueue::TryPush(const BoardSnapshot& snapshot) {
+  size_t position = write_position_.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = cells_[position & mask_];
+    const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence == position) {
+      // The cell is free; claim it unless another writer got there first
+      if (write_position_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+        cell.snapshot = snapshot;
+        cell.sequence.store(position + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (sequence < position) {
+      // The reader has not freed this cell yet, so the queue is full
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = write_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool SnapshotQueue::TryPop(BoardSnapshot& snapshot) {
+  size_t position = read_position_.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = cells_[position & mask_];
+    const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence == position + 1) {
+      if (read_position_.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+        snapshot = cell.snapshot;
+        // Frees the cell for the writer one lap later
+        cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (sequence < position + 1) {
+      return false; // Nothing has been written here yet
+    } else {
+      position = read_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+long long SnapshotQueue::GetNumDropped() const {
+  return num_dropped_.load(std::memory_order_relaxed);
+}
+
+}  // namespace logic
@@ -0,0 +1,83 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+// These replace the global allocation functions for the whole test program.
+// They are kept apart from any code that allocates, so the compiler never
+// inlines them next to its own idea of operator new. Every form is replaced,
+// so memory is always freed by the same allocator that made it.
+namespace {
+
+thread_local bool is_counting = false;
+thread_local long long allocation_count = 0;
+
+void* Allocate(std::size_t size) noexcept {
+  if (is_counting) {
+    allocation_count++;
+  }
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  if (void* memory = Allocate(size)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  if (void* memory = Allocate(size)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
+
+AllocationCounter::AllocationCounter()
+    : start_{allocation_count}, was_counting_{is_counting} {
+  is_counting = true;
+}
+
+AllocationCounter::~AllocationCounter() {
+  is_counting = was_counting_;
+}
+
+long long AllocationCounter::GetAllocations() const {
+  return allocation_count - start_;
+}
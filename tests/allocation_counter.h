@@ -0,0 +1,33 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#ifndef FINALPROJECT_TESTS_ALLOCATION_COUNTER_H_
+#define FINALPROJECT_TESTS_ALLOCATION_COUNTER_H_
+
+/**
+ * Counts the heap allocations the current thread makes while it exists.
+ *
+ * The test program replaces the global operator new and delete on purpose
+ * (see allocation_counter.cc), since that is the only way to see every
+ * allocation. The replacements only count while a counter is alive on the
+ * allocating thread, so every other test runs as if they were not there.
+ */
+class AllocationCounter {
+ public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  AllocationCounter(const AllocationCounter&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  /**
+   * @return how many allocations this thread made since the counter was
+   * created
+   */
+  long long GetAllocations() const;
+
+ private:
+  long long start_;
+  bool was_counting_;
+};
+
+#endif  // FINALPROJECT_TESTS_ALLOCATION_COUNTER_H_
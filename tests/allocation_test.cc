@@ -0,0 +1,63 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/logic.h>
+
+#include "allocation_counter.h"
+
+/**
+ * Builds the starting Othello board used by the app.
+ *
+ * @return a game board with the four starting pieces in the middle
+ */
+vector<vector<string>> GetStartingBoard() {
+  vector<vector<string>> game_board(logic::kBoardSize, vector<string>(logic::kBoardSize));
+  game_board[3][3] = "white";
+  game_board[3][4] = "black";
+  game_board[4][3] = "black";
+  game_board[4][4] = "white";
+  return game_board;
+}
+
+TEST_CASE("Hot paths do not allocate", "[allocation]") {
+  vector<vector<string>> game_board = GetStartingBoard();
+  vector<vector<string>> potential_game_board = GetStartingBoard();
+  int x_move = 2;
+  int y_move = 3;
+
+  SECTION("The allocation counter sees allocations") {
+    AllocationCounter counter;
+    vector<pair<int, int>> moves = logic::GetValidMoves(game_board, false);
+    REQUIRE(counter.GetAllocations() > 0);
+  }
+
+  SECTION("Checking a move does not allocate") {
+    AllocationCounter counter;
+    const bool is_valid = logic::IsMoveValid(x_move, y_move, false,
+                                             game_board);
+    REQUIRE(counter.GetAllocations() == 0);
+    REQUIRE(is_valid);
+  }
+
+  SECTION("Finding valid moves into a buffer does not allocate") {
+    logic::MoveBuffer moves;
+    AllocationCounter counter;
+    const size_t num_moves = logic::GetValidMoves(game_board, false, moves);
+    const uint64_t move_mask = logic::GetValidMoveMask(game_board, false);
+    REQUIRE(counter.GetAllocations() == 0);
+    REQUIRE(num_moves == 4);
+    REQUIRE(move_mask == ((1ULL << 19) | (1ULL << 26) | (1ULL << 37)
+                          | (1ULL << 44)));
+    REQUIRE(moves[0] == pair<int, int>(2, 3));
+  }
+
+  SECTION("Flipping pieces in place does not allocate") {
+    AllocationCounter counter;
+    potential_game_board = game_board;
+    const int num_flipped = logic::FlipPiecesInPlace(x_move, y_move, false,
+                                                     potential_game_board);
+    REQUIRE(counter.GetAllocations() == 0);
+    REQUIRE(num_flipped == 1);
+    REQUIRE(potential_game_board[3][3] == "black");
+  }
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/analysis_cache.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+const char kTestCachePath[] = "analysis_cache_test.bin";
+
+/**
+ * Makes a different position for every index, by playing random moves.
+ *
+ * @param index which position to make
+ * @return a position reached from the start of the game
+ */
+logic::Position GetTestPosition(uint64_t index) {
+  logic::XorShift64 rng(index);
+  logic::Position position = logic::InitialPosition();
+  for (int i = 0; i < 12; i++) {
+    uint64_t moves = logic::GetMoveMask(position);
+    if (moves == 0) {
+      break;
+    }
+    for (uint32_t k = rng.NextBelow(
+             static_cast<uint32_t>(logic::CountDiscs(moves))); k > 0; k--) {
+      moves &= moves - 1;
+    }
+    position = logic::ApplyMove(position, logic::LowestSquare(moves));
+  }
+  return position;
+}
+
+/**
+ * @param position any position
+ * @return an analysis that can be told apart from other positions' analyses
+ */
+logic::CachedAnalysis GetTestAnalysis(const logic::Position& position) {
+  logic::CachedAnalysis analysis;
+  analysis.depth = logic::CountDiscs(position.black);
+  analysis.score = logic::CountDiscs(position.black)
+      - logic::CountDiscs(position.white);
+  analysis.best_move = logic::LowestSquare(position.black);
+  return analysis;
+}
+
+TEST_CASE("The analysis cache stores and finds positions",
+          "[analysis-cache]") {
+  std::remove(kTestCachePath);
+  const logic::Position position = logic::InitialPosition();
+  logic::CachedAnalysis analysis;
+  analysis.depth = 6;
+  analysis.score = -12;
+  analysis.best_move = 19;
+
+  SECTION("A stored position can be looked up") {
+    logic::AnalysisCache cache(kTestCachePath, 1024);
+    logic::CachedAnalysis found;
+    REQUIRE(!cache.Lookup(position, found));
+    cache.Store(position, analysis);
+    REQUIRE(cache.Lookup(position, found));
+    REQUIRE(found.depth == 6);
+    REQUIRE(found.score == -12);
+    REQUIRE(found.best_move == 19);
+  }
+
+  SECTION("A shallower analysis does not replace a deeper one") {
+    logic::AnalysisCache cache(kTestCachePath, 1024);
+    cache.Store(position, analysis);
+    logic::CachedAnalysis shallow = analysis;
+    shallow.depth = 2;
+    shallow.score = 40;
+    cache.Store(position, shallow);
+    logic::CachedAnalysis found;
+    REQUIRE(cache.Lookup(position, found));
+    REQUIRE(found.score == -12);
+  }
+
+  SECTION("Searches and playouts of a position are kept apart") {
+    logic::AnalysisCache cache(kTestCachePath, 1024);
+    logic::CachedAnalysis playouts;
+    playouts.kind = logic::AnalysisKind::kPlayouts;
+    playouts.depth = 100000;
+    playouts.score = logic::kPlayoutScoreScale / 4;
+    cache.Store(position, playouts);
+    cache.Store(position, analysis);
+
+    logic::CachedAnalysis found;
+    REQUIRE(cache.Lookup(position, found));
+    REQUIRE(found.kind == logic::AnalysisKind::kSearch);
+    REQUIRE(found.depth == 6);
+    REQUIRE(cache.Lookup(position, found, logic::AnalysisKind::kPlayouts));
+    REQUIRE(found.kind == logic::AnalysisKind::kPlayouts);
+    REQUIRE(found.depth == 100000);
+    REQUIRE(found.score == logic::kPlayoutScoreScale / 4);
+    REQUIRE(found.best_move == logic::kNoMove);
+  }
+
+  SECTION("A pass is told apart from an unknown best move") {
+    logic::AnalysisCache cache(kTestCachePath, 1024);
+    analysis.best_move = logic::kPassMove;
+    cache.Store(position, analysis);
+    logic::CachedAnalysis found;
+    REQUIRE(cache.Lookup(position, found));
+    REQUIRE(found.best_move == logic::kPassMove);
+  }
+
+  SECTION("Stored positions are still there after reopening the file") {
+    {
+      logic::AnalysisCache cache(kTestCachePath, 1024);
+      cache.Store(position, analysis);
+    }
+    // The file keeps its size, whatever size is asked for now
+    logic::AnalysisCache reopened(kTestCachePath, 16);
+    REQUIRE(reopened.GetNumSlots() == 1024);
+    logic::CachedAnalysis found;
+    REQUIRE(reopened.Lookup(position, found));
+    REQUIRE(found.depth == 6);
+  }
+
+  SECTION("A file that is not a cache is rejected") {
+    {
+      std::ofstream file(kTestCachePath, std::ios::binary);
+      for (int i = 0; i < 1000; i++) {
+        file << "not a cache";
+      }
+    }
+    REQUIRE_THROWS_AS(logic::AnalysisCache(kTestCachePath, 1024),
+                      std::runtime_error);
+  }
+
+  SECTION("A file whose size does not match its header is rejected") {
+    { logic::AnalysisCache cache(kTestCachePath, 1024); }
+    {
+      std::ofstream file(kTestCachePath, std::ios::binary | std::ios::app);
+      file << "extra";
+    }
+    REQUIRE_THROWS_AS(logic::AnalysisCache(kTestCachePath, 1024),
+                      std::runtime_error);
+  }
+
+  std::remove(kTestCachePath);
+}
+
+TEST_CASE("Caches created at the same time agree on their size",
+          "[analysis-cache]") {
+  for (int round = 0; round < 20; round++) {
+    std::remove(kTestCachePath);
+    // Every opener asks for a different size, but only the first one to
+    // create the file gets to choose it
+    std::vector<size_t> num_slots(8);
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_slots.size(); i++) {
+      threads.emplace_back([&num_slots, &failures, i] {
+        try {
+          logic::AnalysisCache cache(kTestCachePath, 64 * (i + 1));
+          num_slots[i] = cache.GetNumSlots();
+        } catch (const std::runtime_error&) {
+          failures++;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(failures == 0);
+    for (size_t slots : num_slots) {
+      REQUIRE(slots == num_slots[0]);
+    }
+  }
+
+  std::remove(kTestCachePath);
+}
+
+TEST_CASE("The analysis cache can be shared between writers",
+          "[analysis-cache]") {
+  std::remove(kTestCachePath);
+  // Two separate mappings of the same file behave like two processes
+  logic::AnalysisCache first_cache(kTestCachePath, 256);
+  logic::AnalysisCache second_cache(kTestCachePath, 256);
+  std::atomic<int> wrong_hits{0};
+
+  auto hammer = [&wrong_hits](logic::AnalysisCache& cache, uint64_t seed) {
+    logic::XorShift64 rng(seed);
+    for (int i = 0; i < 20000; i++) {
+      const logic::Position position = GetTestPosition(rng.NextBelow(2000));
+      logic::CachedAnalysis found;
+      if (cache.Lookup(position, found)) {
+        const logic::CachedAnalysis expected = GetTestAnalysis(position);
+        if (found.score != expected.score
+            || found.best_move != expected.best_move) {
+          wrong_hits++;
+        }
+      } else {
+        cache.Store(position, GetTestAnalysis(position));
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint64_t i = 0; i < 4; i++) {
+    threads.emplace_back(hammer, std::ref(i % 2 == 0 ? first_cache
+                                                     : second_cache), i);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Entries may be overwritten, but a hit must never return another
+  // position's analysis or a half-written one
+  REQUIRE(wrong_hits == 0);
+
+  std::remove(kTestCachePath);
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/features.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+const char kTestFeaturesPath[] = "features_test.npy";
+const char kTestLabelsPath[] = "labels_test.npy";
+const size_t kNpyHeaderSize = 128;
+
+/**
+ * @param path the path of a file
+ * @return every byte of the file
+ */
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+TEST_CASE("Features of the starting position", "[features]") {
+  const logic::FeatureVector features =
+      logic::ExtractFeatures(logic::InitialPosition());
+
+  REQUIRE(features[logic::kOwnDiscs] == Approx(2));
+  REQUIRE(features[logic::kOpponentDiscs] == Approx(2));
+  REQUIRE(features[logic::kEmptySquares] == Approx(60));
+  REQUIRE(features[logic::kOwnMobility] == Approx(4));
+  REQUIRE(features[logic::kOpponentMobility] == Approx(4));
+  REQUIRE(features[logic::kOwnFrontier] == Approx(2));
+  REQUIRE(features[logic::kOpponentFrontier] == Approx(2));
+  REQUIRE(features[logic::kOwnCorners] == Approx(0));
+  REQUIRE(features[logic::kOwnXSquares] == Approx(0));
+  REQUIRE(features[logic::kOwnStable] == Approx(0));
+  REQUIRE(features[logic::kParity] == Approx(0));
+}
+
+TEST_CASE("Stable discs", "[features]") {
+  logic::Position position;
+
+  SECTION("Discs anchored to a corner along an edge are stable") {
+    position.black = 0x7ULL; // (0, 0), (0, 1) and (0, 2)
+    position.white = 1ULL << 3;
+    REQUIRE(logic::GetStableDiscs(position, false) == 0x7ULL);
+    REQUIRE(logic::GetStableDiscs(position, true) == 0);
+  }
+
+  SECTION("An edge disc away from the corners is not stable") {
+    position.black = 1ULL << 3;
+    REQUIRE(logic::GetStableDiscs(position, false) == 0);
+  }
+
+  SECTION("Every disc on a full board is stable") {
+    position.black = 0x00FF00FF00FF00FFULL;
+    position.white = ~position.black;
+    REQUIRE(logic::GetStableDiscs(position, false) == position.black);
+    REQUIRE(logic::GetStableDiscs(position, true) == position.white);
+  }
+}
+
+TEST_CASE("The batch kernel matches single positions", "[features]") {
+  std::vector<logic::Position> positions;
+  logic::XorShift64 rng(5);
+  logic::Position position = logic::InitialPosition();
+  while (!logic::IsTerminal(position)) {
+    positions.push_back(position);
+    position = logic::ApplyMove(position, logic::PickRandomMove(position, rng));
+  }
+
+  std::vector<float> rows(positions.size() * logic::kNumFeatures);
+  logic::ExtractFeatures(positions.data(), positions.size(), rows.data());
+  for (size_t i = 0; i < positions.size(); i++) {
+    const logic::FeatureVector features =
+        logic::ExtractFeatures(positions[i]);
+    for (int j = 0; j < logic::kNumFeatures; j++) {
+      REQUIRE(rows[i * logic::kNumFeatures + j] == Approx(features[j]));
+    }
+  }
+}
+
+TEST_CASE("Random games are exported as .npy files", "[features]") {
+  const long long num_rows = logic::ExportRandomGames(
+      kTestFeaturesPath, kTestLabelsPath, 200, 11);
+  REQUIRE(num_rows > 200 * 50);
+
+  const std::string features = ReadFile(kTestFeaturesPath);
+  const std::string labels = ReadFile(kTestLabelsPath);
+  REQUIRE(features.substr(1, 5) == "NUMPY");
+  REQUIRE(features.find("'shape': (" + std::to_string(num_rows) + ", "
+                        + std::to_string(logic::kNumFeatures) + ")")
+          != std::string::npos);
+  REQUIRE(labels.find("'shape': (" + std::to_string(num_rows) + ",)")
+          != std::string::npos);
+  REQUIRE(features.size() == kNpyHeaderSize + static_cast<size_t>(num_rows)
+          * logic::kNumFeatures * sizeof(float));
+  REQUIRE(labels.size() == kNpyHeaderSize
+          + static_cast<size_t>(num_rows) * sizeof(float));
+
+  // Every game starts from the initial position, which comes first
+  const logic::FeatureVector initial =
+      logic::ExtractFeatures(logic::InitialPosition());
+  const float* first_row =
+      reinterpret_cast<const float*>(features.data() + kNpyHeaderSize);
+  for (int j = 0; j < logic::kNumFeatures; j++) {
+    REQUIRE(first_row[j] == Approx(initial[j]));
+  }
+
+  std::remove(kTestFeaturesPath);
+  std::remove(kTestLabelsPath);
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/game_session.h>
+
+TEST_CASE("Clicking plays moves", "[game-session]") {
+  logic::GameSession session;
+
+  SECTION("A valid move flips pieces and hands over the turn") {
+    const logic::ClickResult result = session.Click(2, 3);
+    REQUIRE(result.is_move_played);
+    REQUIRE(!result.is_game_over);
+    REQUIRE(session.GetGameBoard()[2][3] == "black");
+    REQUIRE(session.GetGameBoard()[3][3] == "black");
+    REQUIRE(session.GetBlackScore() == 4);
+    REQUIRE(session.GetWhiteScore() == 1);
+    REQUIRE(session.IsWhiteTurn());
+    REQUIRE(session.GetHistory().GetNumPlies() == 1);
+  }
+
+  SECTION("An invalid move or a click off the board changes nothing") {
+    REQUIRE(!session.Click(0, 0).is_move_played);
+    REQUIRE(!session.Click(10, 3).is_move_played);
+    REQUIRE(!session.IsWhiteTurn());
+    REQUIRE(session.GetValidMoves().size() == 4);
+    REQUIRE(session.GetHistory().GetNumPlies() == 0);
+  }
+
+  SECTION("Undo and reset go back to the start") {
+    session.Click(2, 3);
+    REQUIRE(session.Undo());
+    REQUIRE(session.GetBlackScore() == 2);
+    REQUIRE(!session.IsWhiteTurn());
+    session.Redo();
+    session.Reset();
+    REQUIRE(session.GetGameBoard()
+            == logic::ToGameBoard(logic::InitialPosition()));
+    REQUIRE(session.GetHistory().GetNumPlies() == 0);
+  }
+}
+
+TEST_CASE("The end of a game is reported once", "[game-session]") {
+  logic::GameSession session;
+  // Black takes white's only disc by playing on 0,0, which ends the game
+  logic::Position position;
+  position.black = 1ULL << 2;
+  position.white = 1ULL << 1;
+  position.is_white_turn = false;
+  session.SetPosition(position);
+
+  REQUIRE(session.Click(0, 0).is_game_over);
+  REQUIRE(session.IsGameOver());
+
+  SECTION("Undoing and playing the last move again does not end it again") {
+    REQUIRE(session.Undo());
+    REQUIRE(!session.IsGameOver());
+    const logic::ClickResult result = session.Click(0, 0);
+    REQUIRE(result.is_move_played);
+    REQUIRE(!result.is_game_over);
+    REQUIRE(session.IsGameOver());
+  }
+
+  SECTION("A new game reports its end again") {
+    session.SetPosition(position);
+    REQUIRE(session.Click(0, 0).is_game_over);
+  }
+}
+
+TEST_CASE("Hovering shows the potential game board", "[game-session]") {
+  logic::GameSession session;
+
+  session.Hover(2, 3);
+  REQUIRE(session.GetPotentialGameBoard()[2][3] == "black");
+  REQUIRE(session.GetPotentialGameBoard()[3][3] == "black");
+  // Only the hover-over board changes
+  REQUIRE(session.GetGameBoard()[2][3].empty());
+
+  session.Hover(0, 0);
+  for (const auto& row : session.GetPotentialGameBoard()) {
+    for (const auto& tile : row) {
+      REQUIRE(tile.empty());
+    }
+  }
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/input_replay.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+const char kTestRecordingPath[] = "input_replay_test.txt";
+const int kTestTileLength = 90;
+
+/**
+ * Records a random game as the app would: the mouse moves over a few tiles
+ * before every click on a valid move, with an undo and redo along the way.
+ *
+ * @param session the session the game is played in
+ * @param seed the seed of the random moves
+ */
+void RecordRandomGame(logic::GameSession& session, uint64_t seed) {
+  logic::InputRecorder recorder(kTestRecordingPath, session,
+                                kTestTileLength);
+  logic::XorShift64 rng(seed);
+  while (!session.IsGameOver()) {
+    for (int i = 0; i < 5; i++) {
+      const int x = static_cast<int>(rng.NextBelow(8 * kTestTileLength));
+      const int y = static_cast<int>(rng.NextBelow(8 * kTestTileLength));
+      recorder.Record(logic::InputEventType::kMouseMove, x, y);
+      session.Hover(x / kTestTileLength, y / kTestTileLength);
+    }
+    const auto& moves = session.GetValidMoves();
+    const auto& move = moves[rng.NextBelow(
+        static_cast<uint32_t>(moves.size()))];
+    const int x = move.first * kTestTileLength + kTestTileLength / 2;
+    const int y = move.second * kTestTileLength + kTestTileLength / 2;
+    recorder.Record(logic::InputEventType::kMouseDown, x, y);
+    session.Click(move.first, move.second);
+    if (session.GetHistory().GetNumPlies() == 10) {
+      recorder.Record(logic::InputEventType::kUndo);
+      session.Undo();
+      recorder.Record(logic::InputEventType::kRedo);
+      session.Redo();
+    }
+  }
+}
+
+TEST_CASE("Recorded input replays to the same game", "[input-replay]") {
+  logic::GameSession played;
+  RecordRandomGame(played, 9);
+  const logic::InputRecording recording =
+      logic::ReadInputRecording(kTestRecordingPath);
+  REQUIRE(recording.tile_length == kTestTileLength);
+  REQUIRE(recording.events.size()
+          == played.GetHistory().GetNumPlies() * 6 + 2);
+
+  SECTION("Applying the events gives the same board") {
+    logic::GameSession replayed;
+    replayed.SetPosition(recording.start);
+    for (const logic::InputEvent& event : recording.events) {
+      logic::ApplyInputEvent(replayed, event, recording.tile_length);
+    }
+    REQUIRE(replayed.GetGameBoard() == played.GetGameBoard());
+    REQUIRE(replayed.IsGameOver());
+  }
+
+  SECTION("The replay times every event") {
+    const logic::ReplayReport report = logic::ReplayInput(recording, 3);
+    REQUIRE(report.clicks.count == 3 * played.GetHistory().GetNumPlies());
+    REQUIRE(report.hovers.count == 5 * report.clicks.count);
+    REQUIRE(report.others.count == 3 * 2);
+    REQUIRE(report.moves_played
+            == static_cast<long long>(report.clicks.count));
+    REQUIRE(report.hovers.p50_us <= report.hovers.p99_us);
+    REQUIRE(report.hovers.p99_us <= report.hovers.max_us);
+  }
+
+  std::remove(kTestRecordingPath);
+}
+
+TEST_CASE("Recordings started mid-game replay undo and redo",
+          "[input-replay]") {
+  // Plays eight moves, then takes two of them back before recording starts
+  logic::GameSession played;
+  for (int i = 0; i < 8; i++) {
+    const auto& move = played.GetValidMoves().front();
+    played.Click(move.first, move.second);
+  }
+  played.JumpToPly(6);
+
+  {
+    logic::InputRecorder recorder(kTestRecordingPath, played,
+                                  kTestTileLength);
+    SECTION("Undoing past the start of the recording") {
+      for (int i = 0; i < 4; i++) {
+        recorder.Record(logic::InputEventType::kUndo);
+        played.Undo();
+      }
+    }
+    SECTION("Redoing moves undone before the recording") {
+      recorder.Record(logic::InputEventType::kJumpToEnd);
+      played.JumpToPly(played.GetHistory().GetNumPlies());
+    }
+    // A move after that has to be played on the same board to match
+    const auto& move = played.GetValidMoves().back();
+    recorder.Record(logic::InputEventType::kMouseDown,
+                    move.first * kTestTileLength,
+                    move.second * kTestTileLength);
+    played.Click(move.first, move.second);
+  }
+
+  const logic::InputRecording recording =
+      logic::ReadInputRecording(kTestRecordingPath);
+  REQUIRE(recording.history.size() == 8);
+  REQUIRE(recording.ply == 6);
+
+  logic::GameSession replayed;
+  logic::RestoreRecordedGame(replayed, recording);
+  for (const logic::InputEvent& event : recording.events) {
+    logic::ApplyInputEvent(replayed, event, recording.tile_length);
+  }
+  REQUIRE(replayed.GetGameBoard() == played.GetGameBoard());
+  REQUIRE(replayed.IsWhiteTurn() == played.IsWhiteTurn());
+  REQUIRE(replayed.GetHistory().GetPly() == played.GetHistory().GetPly());
+  REQUIRE(logic::ReplayInput(recording, 1).moves_played == 1);
+
+  std::remove(kTestRecordingPath);
+}
+
+TEST_CASE("Malformed recordings are rejected", "[input-replay]") {
+  {
+    std::ofstream file(kTestRecordingPath);
+    file << "othello-input-recording 2\n90 0 0 0\n0 0\n15 jump 1 2\n";
+  }
+  REQUIRE_THROWS_AS(logic::ReadInputRecording(kTestRecordingPath),
+                    std::runtime_error);
+  std::remove(kTestRecordingPath);
+  REQUIRE_THROWS_AS(logic::ReadInputRecording(kTestRecordingPath),
+                    std::runtime_error);
+}
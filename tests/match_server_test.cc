@@ -0,0 +1,215 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/game_pool.h>
+#include <mylibrary/match_load.h>
+#include <mylibrary/match_protocol.h>
+#include <mylibrary/match_server.h>
+#include <sqlite_modern_cpp.h>
+
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+const char kTestServerDbPath[] = "match_server_test.db";
+const char kTestSocketPath[] = "match_server_test.sock";
+
+TEST_CASE("Match protocol messages round-trip", "[match-server]") {
+  uint8_t buffer[othello::kMaxMessageSize];
+
+  SECTION("Requests") {
+    othello::MatchRequest request;
+    request.type = othello::kPlayMove;
+    request.tag = 0xDEADBEEF;
+    request.game_id = 123456;
+    request.square = 37;
+    const size_t size = othello::EncodeRequest(request, buffer);
+    REQUIRE(size == othello::kPlayMoveSize);
+
+    othello::MatchRequest decoded;
+    REQUIRE(othello::DecodeRequest(buffer, size - 1, decoded) == 0);
+    REQUIRE(othello::DecodeRequest(buffer, size, decoded) == size);
+    REQUIRE(decoded.tag == request.tag);
+    REQUIRE(decoded.game_id == request.game_id);
+    REQUIRE(decoded.square == request.square);
+
+    buffer[0] = 42;
+    REQUIRE_THROWS_AS(othello::DecodeRequest(buffer, size, decoded),
+                      std::runtime_error);
+  }
+
+  SECTION("Game updates") {
+    othello::GameUpdate update;
+    update.tag = 7;
+    update.game_id = 99;
+    update.status = othello::kIllegalMove;
+    update.is_game_over = true;
+    update.position = logic::InitialPosition();
+    update.position.is_white_turn = true;
+    REQUIRE(othello::EncodeGameUpdate(update, buffer)
+            == othello::kGameUpdateSize);
+
+    othello::GameUpdate decoded;
+    REQUIRE(othello::DecodeGameUpdate(buffer, othello::kGameUpdateSize,
+                                      decoded) == othello::kGameUpdateSize);
+    REQUIRE(decoded.tag == 7);
+    REQUIRE(decoded.game_id == 99);
+    REQUIRE(decoded.status == othello::kIllegalMove);
+    REQUIRE(decoded.is_game_over);
+    REQUIRE(decoded.position.black == update.position.black);
+    REQUIRE(decoded.position.white == update.position.white);
+    REQUIRE(decoded.position.is_white_turn);
+  }
+}
+
+TEST_CASE("The game pool reuses slots safely", "[match-server]") {
+  othello::GamePool pool(2);
+  const uint32_t first = pool.Create(1);
+  const uint32_t second = pool.Create(2);
+  REQUIRE(pool.Create(1) == othello::GamePool::kNoGame);
+  REQUIRE(pool.GetNumGames() == 2);
+
+  REQUIRE(pool.Find(first, 1) != nullptr);
+  // Games can only be reached by their owner
+  REQUIRE(pool.Find(first, 2) == nullptr);
+
+  pool.Release(first);
+  const uint32_t reused = pool.Create(3);
+  REQUIRE(reused != first);
+  // The old id does not reach the game that took over its slot
+  REQUIRE(pool.Find(first, 3) == nullptr);
+  REQUIRE(pool.Find(reused, 3) != nullptr);
+
+  pool.ReleaseAll(2);
+  REQUIRE(pool.Find(second, 2) == nullptr);
+  REQUIRE(pool.GetNumGames() == 1);
+}
+
+TEST_CASE("The game pool ends only the games of one owner",
+          "[match-server]") {
+  othello::GamePool pool(64);
+  std::vector<uint32_t> first_owner_games;
+  std::vector<uint32_t> second_owner_games;
+  for (int i = 0; i < 16; i++) {
+    first_owner_games.push_back(pool.Create(3));
+    second_owner_games.push_back(pool.Create(7));
+  }
+  // Ends games at the front, in the middle and at the end of the list
+  pool.Release(first_owner_games[15]);
+  pool.Release(first_owner_games[8]);
+  pool.Release(first_owner_games[0]);
+  REQUIRE(pool.GetNumGames() == 29);
+
+  pool.ReleaseAll(3);
+  REQUIRE(pool.GetNumGames() == 16);
+  for (uint32_t game_id : first_owner_games) {
+    REQUIRE(pool.Find(game_id, 3) == nullptr);
+  }
+  for (uint32_t game_id : second_owner_games) {
+    REQUIRE(pool.Find(game_id, 7) != nullptr);
+  }
+
+  // Owners without games and negative owners are ignored
+  pool.ReleaseAll(5);
+  pool.ReleaseAll(1000);
+  REQUIRE(pool.Create(-1) == othello::GamePool::kNoGame);
+  REQUIRE(pool.GetNumGames() == 16);
+
+  pool.ReleaseAll(7);
+  REQUIRE(pool.GetNumGames() == 0);
+  REQUIRE(pool.Create(3) != othello::GamePool::kNoGame);
+}
+
+TEST_CASE("The match server hosts games and records them",
+          "[match-server]") {
+  std::remove(kTestServerDbPath);
+  {
+    othello::Scoreboard scoreboard(kTestServerDbPath);
+    othello::MatchServerOptions options;
+    options.max_games = 1024;
+    options.score_batch_size = 16;
+    othello::MatchServer server(scoreboard, options);
+    server.ListenUnix(kTestSocketPath);
+    const uint16_t port = server.ListenTcp(0);
+    std::thread server_thread([&server]() { server.Run(); });
+
+    othello::LoadTestOptions load;
+    load.connections = 2;
+    load.games_per_connection = 32;
+    load.duration = std::chrono::milliseconds(300);
+
+    SECTION("Over a Unix socket") {
+      load.unix_path = kTestSocketPath;
+    }
+    SECTION("Over TCP") {
+      load.port = port;
+    }
+    const othello::LoadTestReport report = othello::RunLoadTest(load);
+    server.Stop();
+    server_thread.join();
+
+    // Every answered move was played by the server, and every finished game
+    // reached the scoreboard once the server stopped. Games can end early,
+    // so a finished game only guarantees that at least one move was played.
+    REQUIRE(report.games_finished > 0);
+    REQUIRE(report.moves >= report.games_finished);
+    REQUIRE(report.p50_latency_us <= report.p99_latency_us);
+    const othello::MatchServerStats stats = server.GetStats();
+    REQUIRE(stats.moves_played == static_cast<uint64_t>(report.moves));
+    REQUIRE(stats.games_finished
+            == static_cast<uint64_t>(report.games_finished));
+    REQUIRE(scoreboard.GetNumGames()
+            == static_cast<size_t>(report.games_finished));
+    REQUIRE(scoreboard.QueryNumGames() == scoreboard.GetNumGames());
+  }
+  std::remove(kTestServerDbPath);
+}
+
+TEST_CASE("The match server keeps serving while the scoreboard fails",
+          "[match-server]") {
+  std::remove(kTestServerDbPath);
+  {
+    othello::Scoreboard scoreboard(kTestServerDbPath);
+    othello::MatchServerOptions options;
+    options.score_batch_size = 4;
+    options.score_flush_interval = std::chrono::milliseconds(10);
+    othello::MatchServer server(scoreboard, options);
+    server.ListenUnix(kTestSocketPath);
+    std::exception_ptr server_error;
+    std::thread server_thread([&server, &server_error]() {
+      try {
+        server.Run();
+      } catch (...) {
+        server_error = std::current_exception();
+      }
+    });
+
+    othello::LoadTestOptions load;
+    load.unix_path = kTestSocketPath;
+    load.connections = 1;
+    load.games_per_connection = 16;
+    load.duration = std::chrono::milliseconds(200);
+
+    // Another connection holding an exclusive lock makes every write to the
+    // scoreboard fail
+    sqlite::database blocker(kTestServerDbPath);
+    blocker << "begin exclusive;";
+    const othello::LoadTestReport blocked = othello::RunLoadTest(load);
+    blocker << "commit;";
+    // The server is still up, and writes the waiting scores once it can
+    const othello::LoadTestReport unblocked = othello::RunLoadTest(load);
+    server.Stop();
+    server_thread.join();
+
+    REQUIRE(!server_error);
+    REQUIRE(blocked.games_finished > 0);
+    REQUIRE(unblocked.games_finished > 0);
+    REQUIRE(server.GetStats().scores_dropped == 0);
+    REQUIRE(scoreboard.GetNumGames() == static_cast<size_t>(
+        blocked.games_finished + unblocked.games_finished));
+    REQUIRE(scoreboard.QueryNumGames() == scoreboard.GetNumGames());
+  }
+  std::remove(kTestServerDbPath);
+}
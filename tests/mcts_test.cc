@@ -0,0 +1,133 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/bitboard.h>
+#include <mylibrary/mcts.h>
+
+using std::vector;
+using std::pair;
+using std::string;
+
+/**
+ * Plays random legal moves on both the string board and the bitboard and
+ * checks that the two rule implementations agree on every move list and on
+ * every resulting board.
+ *
+ * @param seed the seed of the random game
+ * @return whether the two implementations agreed for the whole game
+ */
+bool BitboardMatchesStringBoard(uint64_t seed) {
+  logic::XorShift64 rng(seed);
+  logic::Position position = logic::InitialPosition();
+  vector<vector<string>> game_board = logic::ToGameBoard(position);
+
+  while (!logic::IsTerminal(position)) {
+    vector<pair<int, int>> moves =
+        logic::GetValidMoves(game_board, position.is_white_turn);
+    const uint64_t move_mask = logic::GetMoveMask(position);
+    if (moves.size() != static_cast<size_t>(logic::CountDiscs(move_mask))) {
+      return false;
+    }
+    if (moves.empty()) {
+      position = logic::ApplyMove(position, logic::kPassMove);
+      continue;
+    }
+
+    pair<int, int> move = moves[rng.NextBelow(
+        static_cast<uint32_t>(moves.size()))];
+    const string color = position.is_white_turn ? "white" : "black";
+    game_board = logic::FlipPieces(move.first, move.second,
+                                   position.is_white_turn, game_board);
+    game_board[move.first][move.second] = color;
+    position = logic::ApplyMove(position,
+                                move.first * logic::kBoardSize + move.second);
+    if (logic::ToGameBoard(position) != game_board) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST_CASE("Bitboards follow the same rules as the game board",
+          "[bitboard]") {
+  logic::Position position = logic::InitialPosition();
+
+  SECTION("Initial position converts to and from the game board") {
+    vector<vector<string>> game_board = logic::ToGameBoard(position);
+    REQUIRE(game_board[3][3] == "white");
+    REQUIRE(game_board[3][4] == "black");
+    logic::Position converted = logic::ToPosition(game_board, false);
+    REQUIRE(converted.black == position.black);
+    REQUIRE(converted.white == position.white);
+  }
+
+  SECTION("Initial moves match the valid moves of the game board") {
+    const uint64_t moves = logic::GetMoveMask(position);
+    REQUIRE(logic::CountDiscs(moves) == 4);
+    REQUIRE((moves >> (2 * logic::kBoardSize + 3) & 1) == 1);
+    REQUIRE((moves >> (5 * logic::kBoardSize + 4) & 1) == 1);
+  }
+
+  SECTION("Random games agree move by move") {
+    for (uint64_t seed = 0; seed < 50; seed++) {
+      REQUIRE(BitboardMatchesStringBoard(seed));
+    }
+  }
+}
+
+TEST_CASE("Random playouts end the game", "[bitboard][playout]") {
+  logic::XorShift64 rng(1);
+  for (int i = 0; i < 100; i++) {
+    const int differential = logic::RandomPlayout(logic::InitialPosition(),
+                                                  rng);
+    REQUIRE(differential >= -logic::kNumSquares);
+    REQUIRE(differential <= logic::kNumSquares);
+  }
+}
+
+TEST_CASE("MCTS engine picks legal moves", "[mcts]") {
+  logic::MctsEngine engine(1 << 16, 2, 7);
+
+  SECTION("Search returns a legal move and fills in its stats") {
+    const int move = engine.Search(2000);
+    const uint64_t legal = logic::GetMoveMask(logic::InitialPosition());
+    REQUIRE((legal >> move & 1) == 1);
+    REQUIRE(engine.GetStats().playouts >= 2000);
+    REQUIRE(engine.GetStats().nodes_used > 1);
+    REQUIRE(engine.GetStats().bytes_per_node > 0);
+  }
+
+  SECTION("The tree of the played move is reused") {
+    const int move = engine.Search(4000);
+    engine.Advance(move);
+    REQUIRE(engine.GetRootVisits() > 0);
+    REQUIRE(engine.GetPosition().black
+            == logic::ApplyMove(logic::InitialPosition(), move).black);
+  }
+
+  SECTION("Setting a different position starts a new tree") {
+    engine.Search(1000);
+    engine.SetPosition(logic::ApplyMove(logic::InitialPosition(),
+                                        2 * logic::kBoardSize + 3));
+    REQUIRE(engine.GetRootVisits() == 0);
+  }
+
+  SECTION("A full arena still lets the search finish") {
+    logic::MctsEngine small_engine(8, 4, 3);
+    const int move = small_engine.Search(500);
+    const uint64_t legal = logic::GetMoveMask(logic::InitialPosition());
+    REQUIRE((legal >> move & 1) == 1);
+    REQUIRE(small_engine.GetStats().nodes_used <= 8);
+  }
+}
+
+TEST_CASE("MCTS engine passes when it has to", "[mcts]") {
+  // White cannot move, but black can still play at (0, 2).
+  vector<vector<string>> game_board(logic::kBoardSize,
+                                    vector<string>(logic::kBoardSize));
+  game_board[0][0] = "black";
+  game_board[0][1] = "white";
+  logic::MctsEngine engine(1 << 10, 1, 5);
+  engine.SetPosition(logic::ToPosition(game_board, true));
+  REQUIRE(engine.Search(100) == logic::kPassMove);
+}
@@ -0,0 +1,174 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/move_analyzer.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+/**
+ * Polls the analyzer, like the render loop does, until every legal move of
+ * the position has a score or the time runs out.
+ *
+ * @param analyzer the analyzer working on position
+ * @param position the position being analyzed
+ * @return whether every legal move got a score in time
+ */
+bool WaitForAllScores(const logic::MoveAnalyzer& analyzer,
+                      const logic::Position& position) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (std::chrono::steady_clock::now() < deadline) {
+    bool is_complete = true;
+    for (uint64_t moves = logic::GetMoveMask(position); moves != 0;
+         moves &= moves - 1) {
+      float score;
+      is_complete = is_complete
+          && analyzer.TryGetScore(logic::LowestSquare(moves), score);
+    }
+    if (is_complete) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+/**
+ * Polls the cache until the analyzer has stored a finished score for every
+ * legal move of the position, or the time runs out. A score can be read as
+ * soon as its first batch is done, but it is only stored once the job ends.
+ *
+ * @param cache the cache the analyzer stores its scores in
+ * @param position the position being analyzed
+ * @param playouts how many playouts go into a finished score
+ * @return whether every legal move was stored in time
+ */
+bool WaitForCachedScores(const logic::AnalysisCache& cache,
+                         const logic::Position& position, int playouts) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (std::chrono::steady_clock::now() < deadline) {
+    bool is_complete = true;
+    for (uint64_t moves = logic::GetMoveMask(position); moves != 0;
+         moves &= moves - 1) {
+      logic::CachedAnalysis cached;
+      is_complete = is_complete
+          && cache.Lookup(logic::ApplyMove(position,
+                                           logic::LowestSquare(moves)),
+                          cached, logic::AnalysisKind::kPlayouts)
+          && cached.depth == playouts;
+    }
+    if (is_complete) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+TEST_CASE("Moves are scored in the background", "[move-analyzer]") {
+  logic::MoveAnalyzer analyzer(2, 500);
+  const logic::Position position = logic::InitialPosition();
+
+  SECTION("Nothing is scored before analysis starts") {
+    float score;
+    REQUIRE(!analyzer.TryGetScore(2 * logic::kBoardSize + 3, score));
+  }
+
+  SECTION("Every legal move gets a score between 0 and 1") {
+    analyzer.Analyze(position);
+    REQUIRE(WaitForAllScores(analyzer, position));
+    float score;
+    REQUIRE(analyzer.TryGetScore(2 * logic::kBoardSize + 3, score));
+    REQUIRE(score >= 0);
+    REQUIRE(score <= 1);
+    REQUIRE(!analyzer.TryGetScore(0, score)); // Not a legal move
+  }
+
+  SECTION("A new position hides the scores of the old one") {
+    analyzer.Analyze(position);
+    REQUIRE(WaitForAllScores(analyzer, position));
+    const logic::Position next =
+        logic::ApplyMove(position, 2 * logic::kBoardSize + 3);
+    analyzer.Analyze(next);
+    REQUIRE(WaitForAllScores(analyzer, next));
+  }
+
+  SECTION("Cancelling hides every score") {
+    analyzer.Analyze(position);
+    analyzer.Cancel();
+    float score;
+    REQUIRE(!analyzer.TryGetScore(2 * logic::kBoardSize + 3, score));
+  }
+}
+
+TEST_CASE("Jobs of an old position never replace newer scores",
+          "[move-analyzer]") {
+  // More workers than moves, so old jobs still run next to the new ones
+  logic::MoveAnalyzer analyzer(8, 64);
+  const logic::Position position = logic::InitialPosition();
+
+  for (int i = 0; i < 500; i++) {
+    // Analyzing the same position again starts new jobs on the same squares
+    // while the old ones are still in their batch
+    analyzer.Analyze(position);
+    std::this_thread::sleep_for(std::chrono::microseconds(20 * (i % 5)));
+    analyzer.Analyze(position);
+    REQUIRE(WaitForAllScores(analyzer, position));
+    // Gives any old job time to finish its batch, which must not hide the
+    // scores of the new analysis
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    for (uint64_t moves = logic::GetMoveMask(position); moves != 0;
+         moves &= moves - 1) {
+      float score;
+      REQUIRE(analyzer.TryGetScore(logic::LowestSquare(moves), score));
+    }
+  }
+}
+
+TEST_CASE("Finished scores are kept in the analysis cache",
+          "[move-analyzer]") {
+  const char kCachePath[] = "move_analyzer_test_cache.bin";
+  std::remove(kCachePath);
+  logic::AnalysisCache cache(kCachePath, 1024);
+  const logic::Position position = logic::InitialPosition();
+  const int square = 2 * logic::kBoardSize + 3;
+  float first_score;
+  {
+    logic::MoveAnalyzer analyzer(2, 500, &cache);
+    analyzer.Analyze(position);
+    // Destroying the analyzer stops unfinished jobs before they are stored
+    REQUIRE(WaitForCachedScores(cache, position, 500));
+    REQUIRE(analyzer.TryGetScore(square, first_score));
+  }
+
+  SECTION("Each move is stored under the position it leads to") {
+    const logic::Position after_move = logic::ApplyMove(position, square);
+    logic::CachedAnalysis cached;
+    REQUIRE(cache.Lookup(after_move, cached, logic::AnalysisKind::kPlayouts));
+    REQUIRE(cached.kind == logic::AnalysisKind::kPlayouts);
+    REQUIRE(cached.depth == 500);
+    REQUIRE(cached.best_move == logic::kNoMove);
+    // Searches never find playout scores
+    REQUIRE(!cache.Lookup(after_move, cached));
+  }
+
+  SECTION("Cached moves are scored as soon as analysis starts") {
+    logic::MoveAnalyzer analyzer(2, 500, &cache);
+    analyzer.Analyze(position);
+    float score;
+    REQUIRE(analyzer.TryGetScore(square, score));
+    REQUIRE(score == Approx(first_score).margin(1e-5));
+  }
+
+  SECTION("Scores with fewer playouts than asked for are run again") {
+    logic::MoveAnalyzer analyzer(2, 2000, &cache);
+    analyzer.Analyze(position);
+    // Only jobs that ran again can store the deeper scores
+    REQUIRE(WaitForCachedScores(cache, position, 2000));
+  }
+
+  std::remove(kCachePath);
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/bitboard.h>
+#include <mylibrary/move_history.h>
+
+using std::vector;
+using std::string;
+
+TEST_CASE("Moves can be undone and redone", "[move-history]") {
+  logic::MoveHistory history;
+  vector<logic::Position> positions = {logic::InitialPosition()};
+
+  // Plays a short random game, remembering every position along the way
+  logic::XorShift64 rng(3);
+  for (int i = 0; i < 20; i++) {
+    logic::Position position = positions.back();
+    uint64_t moves = logic::GetMoveMask(position);
+    if (moves == 0) {
+      break;
+    }
+    for (uint32_t k = rng.NextBelow(
+             static_cast<uint32_t>(logic::CountDiscs(moves))); k > 0; k--) {
+      moves &= moves - 1;
+    }
+    const int square = logic::LowestSquare(moves);
+    logic::Position next = logic::ApplyMove(position, square);
+    history.Record(position, square, next.is_white_turn);
+    positions.push_back(next);
+  }
+  vector<vector<string>> game_board = logic::ToGameBoard(positions.back());
+  bool is_white_turn = positions.back().is_white_turn;
+
+  SECTION("Undo steps back through every position") {
+    for (size_t ply = positions.size() - 1; ply > 0; ply--) {
+      REQUIRE(history.Undo(game_board, is_white_turn));
+      REQUIRE(game_board == logic::ToGameBoard(positions[ply - 1]));
+      REQUIRE(is_white_turn == positions[ply - 1].is_white_turn);
+    }
+    REQUIRE(!history.Undo(game_board, is_white_turn));
+  }
+
+  SECTION("Redo plays the undone moves again") {
+    history.JumpToPly(0, game_board, is_white_turn);
+    REQUIRE(game_board == logic::ToGameBoard(positions.front()));
+    for (size_t ply = 1; ply < positions.size(); ply++) {
+      REQUIRE(history.Redo(game_board, is_white_turn));
+      REQUIRE(game_board == logic::ToGameBoard(positions[ply]));
+    }
+    REQUIRE(!history.Redo(game_board, is_white_turn));
+  }
+
+  SECTION("Jumping to a ply restores that position") {
+    history.JumpToPly(5, game_board, is_white_turn);
+    REQUIRE(history.GetPly() == 5);
+    REQUIRE(game_board == logic::ToGameBoard(positions[5]));
+    history.JumpToPly(12, game_board, is_white_turn);
+    REQUIRE(game_board == logic::ToGameBoard(positions[12]));
+  }
+
+  SECTION("Recording a move after undoing forgets the undone moves") {
+    history.JumpToPly(0, game_board, is_white_turn);
+    const int square = logic::LowestSquare(
+        logic::GetMoveMask(positions.front()));
+    history.Record(positions.front(), square, true);
+    REQUIRE(history.GetPly() == 1);
+    REQUIRE(history.GetNumPlies() == 1);
+  }
+}
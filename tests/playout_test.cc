@@ -0,0 +1,49 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/playout.h>
+
+#include <numeric>
+
+TEST_CASE("Playout batches count every game", "[playout-batch]") {
+  const logic::Position position = logic::InitialPosition();
+  const long long num_playouts = 5000;
+
+  SECTION("Every playout is counted once") {
+    logic::PlayoutResult result =
+        logic::PlayoutBatch(position, num_playouts, 42, 2);
+    REQUIRE(result.playouts == num_playouts);
+    REQUIRE(result.wins + result.draws + result.losses == num_playouts);
+    REQUIRE(std::accumulate(result.disc_differentials.begin(),
+                            result.disc_differentials.end(), 0LL)
+            == num_playouts);
+    REQUIRE(result.disc_differentials[logic::kMaxDiscDifferential]
+            == result.draws);
+  }
+
+  SECTION("Results only depend on the seed, not the number of threads") {
+    logic::PlayoutResult one_thread =
+        logic::PlayoutBatch(position, num_playouts, 7, 1);
+    logic::PlayoutResult four_threads =
+        logic::PlayoutBatch(position, num_playouts, 7, 4);
+    REQUIRE(one_thread.wins == four_threads.wins);
+    REQUIRE(one_thread.losses == four_threads.losses);
+    REQUIRE(one_thread.disc_differentials
+            == four_threads.disc_differentials);
+
+    logic::PlayoutResult other_seed =
+        logic::PlayoutBatch(position, num_playouts, 8, 4);
+    REQUIRE(one_thread.disc_differentials != other_seed.disc_differentials);
+  }
+
+  SECTION("Finished games always end the same way") {
+    // White to move with only white discs left, so every playout is a win
+    logic::Position finished;
+    finished.white = 1;
+    finished.is_white_turn = true;
+    logic::PlayoutResult result = logic::PlayoutBatch(finished, 100, 1, 3);
+    REQUIRE(result.wins == 100);
+    REQUIRE(result.disc_differentials[logic::kMaxDiscDifferential + 1]
+            == 100);
+  }
+}
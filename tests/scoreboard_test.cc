@@ -0,0 +1,140 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include <catch2/catch.hpp>
+#include <mylibrary/scoreboard.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+const char kTestDbPath[] = "scoreboard_test.db";
+
+/**
+ * Fills a fresh leaderboard with a spread of games between black and white,
+ * with the occasional tie.
+ *
+ * @param scoreboard the empty leaderboard to fill
+ * @param num_games how many games to add
+ */
+void AddGames(othello::Scoreboard& scoreboard, int num_games) {
+  for (int i = 0; i < num_games; i++) {
+    const int score = 33 + (i * 7) % 31;
+    if (i % 10 == 0) {
+      scoreboard.AddWinnerToScoreBoard("tie", "tie", 32);
+    } else if (i % 2 == 0) {
+      scoreboard.AddWinnerToScoreBoard("black", "white", score);
+    } else {
+      scoreboard.AddWinnerToScoreBoard("white", "black", score);
+    }
+  }
+}
+
+/**
+ * @param entries leaderboard rows
+ * @return only the scores of the rows, in the same order
+ */
+vector<int> GetScores(const vector<othello::ScoreEntry>& entries) {
+  vector<int> scores;
+  for (const auto& entry : entries) {
+    scores.push_back(entry.score);
+  }
+  return scores;
+}
+
+/**
+ * Checks that the in-memory leaderboard answers every read the same way as
+ * the database does.
+ *
+ * @param scoreboard the leaderboard to check
+ * @return whether memory and database agree
+ */
+bool CacheMatchesDatabase(othello::Scoreboard& scoreboard) {
+  if (GetScores(scoreboard.GetTopScores())
+      != GetScores(scoreboard.QueryTopScores())) {
+    return false;
+  }
+  if (scoreboard.GetNumGames() != scoreboard.QueryNumGames()) {
+    return false;
+  }
+  for (const string player : {"black", "white", "tie", "nobody"}) {
+    othello::PlayerStats cached = scoreboard.GetPlayerStats(player);
+    othello::PlayerStats queried = scoreboard.QueryPlayerStats(player);
+    if (cached.wins != queried.wins || cached.losses != queried.losses
+        || cached.ties != queried.ties
+        || cached.best_score != queried.best_score) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST_CASE("The leaderboard cache matches the database", "[scoreboard]") {
+  std::remove(kTestDbPath);
+
+  SECTION("An empty leaderboard has no games") {
+    othello::Scoreboard scoreboard(kTestDbPath);
+    REQUIRE(scoreboard.GetNumGames() == 0);
+    REQUIRE(scoreboard.GetTopScores().empty());
+    REQUIRE(CacheMatchesDatabase(scoreboard));
+  }
+
+  SECTION("Added games show up in memory and in the database") {
+    othello::Scoreboard scoreboard(kTestDbPath, 5);
+    AddGames(scoreboard, 40);
+    REQUIRE(scoreboard.GetNumGames() == 40);
+    REQUIRE(scoreboard.GetTopScores().size() == 5);
+    REQUIRE(scoreboard.GetPlayerStats("tie").ties == 4);
+    REQUIRE(CacheMatchesDatabase(scoreboard));
+  }
+
+  SECTION("A new scoreboard loads the games already in the database") {
+    {
+      othello::Scoreboard scoreboard(kTestDbPath);
+      AddGames(scoreboard, 25);
+    }
+    othello::Scoreboard reopened(kTestDbPath);
+    REQUIRE(reopened.GetNumGames() == 25);
+    REQUIRE(CacheMatchesDatabase(reopened));
+  }
+
+  SECTION("Games can be added in one batch") {
+    othello::Scoreboard scoreboard(kTestDbPath, 5);
+    AddGames(scoreboard, 10);
+    scoreboard.AddGamesToScoreBoard({{"black", "white", 64},
+                                     {"tie", "tie", 32},
+                                     {"white", "black", 41}});
+    REQUIRE(scoreboard.GetNumGames() == 13);
+    REQUIRE(scoreboard.GetTopScores().front().score == 64);
+    REQUIRE(CacheMatchesDatabase(scoreboard));
+  }
+
+  std::remove(kTestDbPath);
+}
+
+// Hidden by default; run with "[.benchmark]" or "[scoreboard-benchmark]".
+TEST_CASE("Cached leaderboard reads versus SQL queries",
+          "[.benchmark][scoreboard-benchmark]") {
+  std::remove(kTestDbPath);
+  othello::Scoreboard scoreboard(kTestDbPath);
+  AddGames(scoreboard, 1000);
+
+  BENCHMARK("Top scores from memory") {
+    return scoreboard.GetTopScores();
+  };
+  BENCHMARK("Top scores from SQL") {
+    return scoreboard.QueryTopScores();
+  };
+  BENCHMARK("Player stats from memory") {
+    return scoreboard.GetPlayerStats("black").wins;
+  };
+  BENCHMARK("Player stats from SQL") {
+    return scoreboard.QueryPlayerStats("black").wins;
+  };
+
+  std::remove(kTestDbPath);
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+#include <catch2/catch.hpp>
+#include <mylibrary/snapshot_queue.h>
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("Snapshots go through the queue in order", "[snapshot-queue]") {
+  logic::SnapshotQueue queue(4);
+  logic::BoardSnapshot snapshot;
+
+  SECTION("An empty queue has nothing to pop") {
+    REQUIRE(!queue.TryPop(snapshot));
+  }
+
+  SECTION("Snapshots come out in the order they went in") {
+    for (uint32_t i = 0; i < 3; i++) {
+      snapshot.game_id = i;
+      REQUIRE(queue.TryPush(snapshot));
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+      REQUIRE(queue.TryPop(snapshot));
+      REQUIRE(snapshot.game_id == i);
+    }
+  }
+
+  SECTION("A full queue drops snapshots instead of blocking") {
+    for (int i = 0; i < 4; i++) {
+      REQUIRE(queue.TryPush(snapshot));
+    }
+    REQUIRE(!queue.TryPush(snapshot));
+    REQUIRE(queue.GetNumDropped() == 1);
+    REQUIRE(queue.TryPop(snapshot));
+    REQUIRE(queue.TryPush(snapshot));
+  }
+}
+
+TEST_CASE("Many game threads can push at once", "[snapshot-queue]") {
+  const uint32_t kNumThreads = 4;
+  const uint32_t kSnapshotsPerThread = 10000;
+  logic::SnapshotQueue queue(256);
+
+  std::vector<std::thread> game_threads;
+  for (uint32_t game = 0; game < kNumThreads; game++) {
+    game_threads.emplace_back([&queue, game, kSnapshotsPerThread] {
+      logic::BoardSnapshot snapshot;
+      snapshot.game_id = game;
+      for (uint32_t i = 0; i < kSnapshotsPerThread; i++) {
+        snapshot.position.black = i;
+        while (!queue.TryPush(snapshot)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Every game's snapshots must arrive complete and in order
+  std::vector<uint64_t> next_expected(kNumThreads, 0);
+  uint32_t num_received = 0;
+  bool is_in_order = true;
+  logic::BoardSnapshot snapshot;
+  while (num_received < kNumThreads * kSnapshotsPerThread) {
+    if (queue.TryPop(snapshot)) {
+      is_in_order = is_in_order
+          && snapshot.position.black == next_expected[snapshot.game_id]++;
+      num_received++;
+    }
+  }
+  for (auto& thread : game_threads) {
+    thread.join();
+  }
+  REQUIRE(is_in_order);
+  REQUIRE(!queue.TryPop(snapshot));
+}
@@ -1,6 +1,7 @@
 // Copyright (c) 2020 CS126SP20. All rights reserved.
 
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 
 #include <catch2/catch.hpp>
 #include <mylibrary/logic.h>
@@ -166,4 +167,42 @@ TEST_CASE("Checks if Coordinates Are In Bounds", "[in-bounds]") {
     // Checks for out-of-bounds coordinates (x or y greater than 7)
     REQUIRE(!logic::InBounds(x_coord, y_coord));
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Checks If The Game Is Over", "[game-over]") {
+  map<pair<int, int>, string> coord_to_color_map
+      = {{make_pair(3, 3), "white"},
+         {make_pair(3, 4), "black"},
+         {make_pair(4, 3), "black"},
+         {make_pair(4, 4), "white"}};
+  vector<vector<string>> game_board = FillGameBoard(coord_to_color_map);
+
+  SECTION("The game is not over at the start") {
+    REQUIRE(!logic::IsGameOver(game_board));
+  }
+
+  SECTION("The game is over when the board is full") {
+    game_board = GetFullBoard(game_board);
+
+    REQUIRE(logic::IsGameOver(game_board));
+  }
+
+  SECTION("The game is over when neither player can move") {
+    // Only black pieces are left, so neither player has a valid move even
+    // though most of the board is empty
+    coord_to_color_map = {{make_pair(3, 3), "black"},
+                          {make_pair(4, 4), "black"}};
+    game_board = FillGameBoard(coord_to_color_map);
+
+    REQUIRE(logic::IsGameOver(game_board));
+  }
+
+  SECTION("The game is not over when only one player has to pass") {
+    // White has no move, but black can still play at (0, 2)
+    coord_to_color_map = {{make_pair(0, 0), "black"},
+                          {make_pair(0, 1), "white"}};
+    game_board = FillGameBoard(coord_to_color_map);
+
+    REQUIRE(!logic::IsGameOver(game_board));
+  }
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+// Plays random games against a match server and reports the throughput and
+// move latency:
+//
+//   match-load <tcp port | unix socket path> [connections]
+//              [games per connection] [seconds]
+
+#include <mylibrary/match_load.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 5) {
+    std::fprintf(stderr,
+                 "usage: %s <port | socket path> [connections] "
+                 "[games per connection] [seconds]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  try {
+    othello::LoadTestOptions options;
+    const std::string address = argv[1];
+    if (address.find_first_not_of("0123456789") == std::string::npos) {
+      options.port = static_cast<uint16_t>(std::stoul(address));
+    } else {
+      options.unix_path = address;
+    }
+    if (argc > 2) {
+      options.connections = std::stoi(argv[2]);
+    }
+    if (argc > 3) {
+      options.games_per_connection = std::stoi(argv[3]);
+    }
+    if (argc > 4) {
+      options.duration = std::chrono::milliseconds(
+          static_cast<long long>(std::stod(argv[4]) * 1000));
+    }
+
+    const othello::LoadTestReport report = othello::RunLoadTest(options);
+    std::printf("%d connections x %d games for %.2f s\n",
+                options.connections, options.games_per_connection,
+                report.seconds);
+    std::printf("%lld moves, %lld games finished\n", report.moves,
+                report.games_finished);
+    std::printf("%.0f moves/s, latency p50 %.1f us, p99 %.1f us, "
+                "max %.1f us\n", report.moves_per_second,
+                report.p50_latency_us, report.p99_latency_us,
+                report.max_latency_us);
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "%s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+// Hosts games for match clients until interrupted:
+//
+//   match-server <scoreboard.db> <tcp port | unix socket path> [max games]
+
+#include <mylibrary/match_server.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+othello::MatchServer* running_server = nullptr;
+
+void StopServer(int) {
+  if (running_server != nullptr) {
+    running_server->Stop();
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 4) {
+    std::fprintf(stderr,
+                 "usage: %s <scoreboard.db> <port | socket path> "
+                 "[max games]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  try {
+    othello::Scoreboard scoreboard(argv[1]);
+    othello::MatchServerOptions options;
+    if (argc == 4) {
+      options.max_games = static_cast<uint32_t>(std::stoul(argv[3]));
+    }
+    othello::MatchServer server(scoreboard, options);
+
+    const std::string address = argv[2];
+    if (address.find_first_not_of("0123456789") == std::string::npos) {
+      const uint16_t port = server.ListenTcp(
+          static_cast<uint16_t>(std::stoul(address)));
+      std::printf("Listening on 127.0.0.1:%u\n", static_cast<unsigned>(port));
+    } else {
+      server.ListenUnix(address);
+      std::printf("Listening on %s\n", address.c_str());
+    }
+    std::fflush(stdout);
+
+    running_server = &server;
+    std::signal(SIGINT, StopServer);
+    std::signal(SIGTERM, StopServer);
+    server.Run();
+    running_server = nullptr;
+
+    const othello::MatchServerStats stats = server.GetStats();
+    std::printf("%llu connections, %llu games, %llu moves, %llu finished\n",
+                static_cast<unsigned long long>(stats.connections),
+                static_cast<unsigned long long>(stats.games_created),
+                static_cast<unsigned long long>(stats.moves_played),
+                static_cast<unsigned long long>(stats.games_finished));
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "%s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2020 Kaahan Motwani. All rights reserved.
+
+// Replays an input recording made with the R key in the app, without opening
+// a window, and prints how long each kind of event took to handle:
+//
+//   replay-input input_recording.txt [repetitions]
+
+#include <mylibrary/input_replay.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+const int kDefaultRepetitions = 100;
+
+void PrintLatencies(const char* name, const logic::LatencyStats& stats) {
+  std::printf("%-7s %9zu %9.2f %9.2f %9.2f %9.2f %9.2f\n", name, stats.count,
+              stats.mean_us, stats.p50_us, stats.p90_us, stats.p99_us,
+              stats.max_us);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    std::fprintf(stderr, "usage: %s <recording> [repetitions]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  const int repetitions = argc == 3 ? std::atoi(argv[2])
+                                    : kDefaultRepetitions;
+  try {
+    const logic::InputRecording recording = logic::ReadInputRecording(argv[1]);
+    const logic::ReplayReport report = logic::ReplayInput(recording,
+                                                          repetitions);
+    std::printf("%zu events x %d repetitions, %lld moves played, %.3f s\n",
+                recording.events.size(), repetitions, report.moves_played,
+                report.seconds);
+    std::printf("%-7s %9s %9s %9s %9s %9s %9s\n", "event", "count",
+                "mean us", "p50 us", "p90 us", "p99 us", "max us");
+    PrintLatencies("click", report.clicks);
+    PrintLatencies("hover", report.hovers);
+    PrintLatencies("other", report.others);
+  } catch (const std::runtime_error& error) {
+    std::fprintf(stderr, "%s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}